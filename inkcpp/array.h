@@ -15,6 +15,16 @@
 
 namespace ink::runtime::internal
 {
+// Size of an open addressing index for the given number of entries (power of two, at most half full)
+constexpr size_t index_capacity(size_t entries)
+{
+	size_t size = 16;
+	while (size < entries * 2) {
+		size *= 2;
+	}
+	return size;
+}
+
 /** Managed array of objects.
  *
  * @tparam simple if the object has a trivial destructor, so delete[](char*) can be used instead of
@@ -291,27 +301,45 @@ void managed_array<T, dynamic, initialCapacity, simple>::extend(size_t capacity)
 	_capacity     = new_capacity;
 }
 
+/** Array which can be saved and later restored or forgotten.
+ *
+ * Values are stored once. After save() the first change of each index records the old value in
+ * a journal, restore() writes the journal back and forget() drops it. So save() is O(1) and
+ * restore()/forget() only cost the number of changed indices.
+ */
 template<typename T>
 class basic_restorable_array : public snapshot_interface
 {
+protected:
+	struct journal_entry {
+		size_t index;
+		T      value;
+	};
+
+	// number of bytes needed to flag capacity indices as journaled
+	static constexpr size_t flag_bytes(size_t capacity) { return (capacity + 7) / 8; }
+
 public:
-	basic_restorable_array(T* array, size_t capacity, T nullValue)
+	basic_restorable_array(
+	    T* array, size_t capacity, journal_entry* journal, size_t journal_capacity,
+	    unsigned char* journaled, T nullValue
+	)
 	    : _saved(false)
 	    , _array(array)
-	    , _temp(array + capacity / 2)
-	    , _capacity(capacity / 2)
+	    , _capacity(capacity)
+	    , _journal(journal)
+	    , _journal_capacity(journal_capacity)
+	    , _journal_size(0)
+	    , _journaled(journaled)
 	    , _null(nullValue)
 	{
-		inkAssert(
-		    capacity % 2 == 0,
-		    "basic_restorable_array requires a datablock of even length to split into two arrays"
-		);
-
-		// zero out main array and put 'nulls' in the clear_temp()
+		// zero out main array and clear the journal flags
 		inkZeroMemory(_array, _capacity * sizeof(T));
-		clear_temp();
+		inkZeroMemory(_journaled, flag_bytes(_capacity));
 	}
 
+	virtual ~basic_restorable_array() = default;
+
 	// not copyable
 	basic_restorable_array(const basic_restorable_array<T>&)               = delete;
 	basic_restorable_array<T>& operator=(const basic_restorable_array<T>&) = delete;
@@ -321,7 +349,6 @@ public:
 
 	// get value by index
 	const T& get(size_t index) const;
-	const T& get_old(size_t index) const;
 
 	// size of the array
 	inline size_t capacity() const { return _capacity; }
@@ -345,6 +372,18 @@ public:
 	// Resets all values and clears any save points
 	void clear(const T& value);
 
+	// Applies callback(T&) to all stored values, including values changed after save()
+	template<typename Callback>
+	void transform(Callback callback)
+	{
+		for (size_t i = 0; i < _capacity; ++i) {
+			callback(_array[i]);
+		}
+		for (size_t i = 0; i < _journal_size; ++i) {
+			callback(_journal[i].value);
+		}
+	}
+
 	// snapshot interface
 	bool                         can_be_migrated() const;
 	size_t                       snap(unsigned char* data, const snapper&) const;
@@ -353,41 +392,76 @@ public:
 protected:
 	inline T* buffer() { return _array; }
 
-	const unsigned char* impl_snap_load_meta(const unsigned char* data);
-	const unsigned char* impl_snap_load_payload(const unsigned char* data);
+	inline journal_entry* journal() { return _journal; }
+
+	inline unsigned char* journaled() { return _journaled; }
+
+	const unsigned char* impl_snap_load_meta(const unsigned char* data, bool compact);
+	const unsigned char* impl_snap_load_payload(const unsigned char* data, bool compact);
 
-	void set_new_buffer(T* buffer, size_t capacity)
+	void set_new_buffer(T* buffer, unsigned char* journaled, size_t capacity)
 	{
-		_array    = buffer;
-		_temp     = buffer + capacity / 2;
-		_capacity = capacity / 2;
+		_array     = buffer;
+		_journaled = journaled;
+		_capacity  = capacity;
 	}
 
+	void set_new_journal(journal_entry* journal, size_t capacity)
+	{
+		_journal          = journal;
+		_journal_capacity = capacity;
+	}
+
+	// Called if the journal is full
+	virtual void overflow_journal() { inkFail("Restorable array journal is full!"); }
+
 private:
 	inline void check_index(size_t index) const
 	{
 		inkAssert(index < capacity(), "Index out of range!");
 	}
 
-	void clear_temp();
+	inline bool is_journaled(size_t index) const
+	{
+		return (_journaled[index / 8] & (1U << (index % 8))) != 0;
+	}
+
+	inline void set_journaled(size_t index, bool flag)
+	{
+		if (flag) {
+			_journaled[index / 8] |= static_cast<unsigned char>(1U << (index % 8));
+		} else {
+			_journaled[index / 8] &= static_cast<unsigned char>(~(1U << (index % 8)));
+		}
+	}
+
+	// value from before save() and the changed value or null, like they are written to snapshots
+	void entry(size_t index, T& value, T& changed) const;
+
+	// record the current value of index, if it is not recorded yet
+	void record(size_t index);
+	void clear_journal();
 
 private:
 	bool _saved;
 
-	// real values live here
-	T* _array;
+	// values live here
+	T*     _array;
+	size_t _capacity;
 
-	// we store values here when we're in safe mode
-	//  they're copied on a call to forget()
-	T* _temp;
+	// values from before save() of every changed index
+	journal_entry* _journal;
+	size_t         _journal_capacity;
+	size_t         _journal_size;
+
+	// one bit per index, set if the index is in the journal
+	unsigned char* _journaled;
 
-	// size of both _array and _temp
-	size_t _capacity;
 	// if loaded with snap_load, this value was the original size, the current capacity might be
-	// higher
-	size_t _loaded_capacity = static_cast<size_t>(~0);
+	// larger
+	size_t _loaded_capacity = ~0;
 
-	// null
+	// marks unchanged values in snapshots
 	const T _null;
 };
 
@@ -397,36 +471,31 @@ inline void basic_restorable_array<T>::set(size_t index, const T& value)
 	check_index(index);
 	inkAssert(value != _null, "Can not add a value considered a 'null' to a restorable_array");
 
-	// If we're saved, store in second half of the array
+	// If we're saved, remember the old value before overwriting it
 	if (_saved) {
-		_temp[index] = value;
-	} else {
-		// Otherwise, store in the main array
-		_array[index] = value;
+		record(index);
 	}
+	_array[index] = value;
 }
 
 template<typename T>
 inline const T& basic_restorable_array<T>::get(size_t index) const
 {
 	check_index(index);
-
-	// If we're in safe mode, and we have a value at that index, return that instead
-	if (_saved && _temp[index] != _null) {
-		return _temp[index];
-	}
-
-	// Otherwise, fall back on the real array
 	return _array[index];
 }
 
 template<typename T>
-inline const T& basic_restorable_array<T>::get_old(size_t index) const
+inline void basic_restorable_array<T>::record(size_t index)
 {
-	check_index(index);
-	inkAssert(_saved, "Use old only on saved arrays.");
-
-	return _array[index];
+	if (is_journaled(index)) {
+		return;
+	}
+	if (_journal_size >= _journal_capacity) {
+		overflow_journal();
+	}
+	set_journaled(index, true);
+	_journal[_journal_size++] = journal_entry{index, _array[index]};
 }
 
 template<typename T>
@@ -439,7 +508,11 @@ inline void basic_restorable_array<T>::save()
 template<typename T>
 inline void basic_restorable_array<T>::restore()
 {
-	clear_temp();
+	// Write back the old values
+	for (size_t i = 0; i < _journal_size; ++i) {
+		_array[_journal[i].index] = _journal[i].value;
+	}
+	clear_journal();
 
 	// Clear saved flag
 	_saved = false;
@@ -448,36 +521,27 @@ inline void basic_restorable_array<T>::restore()
 template<typename T>
 inline void basic_restorable_array<T>::forget()
 {
-	// Run through the _temp array
-	for (size_t i = 0; i < _capacity; i++) {
-		// Copy if there are values
-		if (_temp[i] != _null) {
-			_array[i] = _temp[i];
-		}
-
-		// Clear
-		_temp[i] = _null;
-	}
-
+	// current values are already in place
+	clear_journal();
 	_saved = false;
 }
 
 template<typename T>
-inline void basic_restorable_array<T>::clear_temp()
+inline void basic_restorable_array<T>::clear_journal()
 {
-	// Run through the _temp array
-	for (size_t i = 0; i < _capacity; i++) {
-		// Clear
-		_temp[i] = _null;
+	for (size_t i = 0; i < _journal_size; ++i) {
+		set_journaled(_journal[i].index, false);
 	}
+	_journal_size = 0;
 }
 
 template<typename T>
 inline void basic_restorable_array<T>::clear(const T& value)
 {
-	_saved = false;
+	_saved        = false;
+	_journal_size = 0;
+	inkZeroMemory(_journaled, flag_bytes(_capacity));
 	for (size_t i = 0; i < _capacity; i++) {
-		_temp[i]  = _null;
 		_array[i] = value;
 	}
 }
@@ -489,7 +553,7 @@ class fixed_restorable_array : public basic_restorable_array<T>
 
 public:
 	fixed_restorable_array(const T& initial, const T& nullValue)
-	    : basic_restorable_array<T>(_buffer, SIZE * 2, nullValue)
+	    : basic_restorable_array<T>(_buffer, SIZE, _journal, SIZE, _journaled, nullValue)
 	{
 		basic_restorable_array<T>::clear(initial);
 	}
@@ -498,27 +562,31 @@ public:
 	    snap_load(const unsigned char* data, const snapshot_interface::loader&) override;
 
 private:
-	T _buffer[SIZE * 2];
+	T                            _buffer[SIZE];
+	typename base::journal_entry _journal[SIZE];
+	unsigned char                _journaled[base::flag_bytes(SIZE)];
 };
 
 template<typename T>
 class allocated_restorable_array : public basic_restorable_array<T>
 {
-	using base = basic_restorable_array<T>;
+	using base          = basic_restorable_array<T>;
+	using journal_entry = typename base::journal_entry;
 
 public:
 	allocated_restorable_array(const T& initial, const T& nullValue)
-	    : basic_restorable_array<T>(0, 0, nullValue)
+	    : basic_restorable_array<T>(nullptr, 0, nullptr, 0, nullptr, nullValue)
 	    , _initialValue{initial}
-	    , _nullValue{nullValue}
 	    , _buffer{nullptr}
 	{
 	}
 
 	allocated_restorable_array(size_t capacity, const T& initial, const T& nullValue)
-	    : basic_restorable_array<T>(new T[capacity * 2], capacity * 2, nullValue)
+	    : basic_restorable_array<T>(
+	          new T[capacity], capacity, nullptr, 0, new unsigned char[base::flag_bytes(capacity)],
+	          nullValue
+	      )
 	    , _initialValue{initial}
-	    , _nullValue{nullValue}
 	{
 		_buffer = this->buffer();
 		this->clear(_initialValue);
@@ -526,40 +594,64 @@ public:
 
 	void resize(size_t n)
 	{
-		size_t new_capacity = 2 * n;
-		T*     new_buffer   = new T[new_capacity];
+		T*             new_buffer    = new T[n];
+		unsigned char* new_journaled = new unsigned char[base::flag_bytes(n)];
+		inkZeroMemory(new_journaled, base::flag_bytes(n));
+		size_t keep = base::capacity() < n ? base::capacity() : n;
 		if (_buffer) {
-			for (size_t i = 0; i < base::capacity() && i < n; ++i) {
-				new_buffer[i]     = _buffer[i];
-				// copy temp
-				new_buffer[i + n] = _buffer[i + base::capacity()];
+			for (size_t i = 0; i < keep; ++i) {
+				new_buffer[i] = _buffer[i];
+			}
+			for (size_t i = 0; i < base::flag_bytes(keep); ++i) {
+				new_journaled[i] = this->journaled()[i];
 			}
 			delete[] _buffer;
+			delete[] this->journaled();
 		}
-		for (size_t i = base::capacity(); i < n; ++i) {
-			new_buffer[i]     = _initialValue;
-			new_buffer[i + n] = _nullValue;
+		for (size_t i = keep; i < n; ++i) {
+			new_buffer[i] = _initialValue;
 		}
 
 		_buffer = new_buffer;
-		this->set_new_buffer(_buffer, new_capacity);
+		this->set_new_buffer(_buffer, new_journaled, n);
 	}
 
 	virtual ~allocated_restorable_array()
 	{
 		if (_buffer) {
 			delete[] _buffer;
+			delete[] this->journaled();
 			_buffer = nullptr;
 		}
+		delete[] _journal_buffer;
 	}
 
 	const unsigned char*
 	    snap_load(const unsigned char* data, const snapshot_interface::loader&) override;
 
+protected:
+	// the journal holds at most one entry per index, so it grows on demand
+	void overflow_journal() override
+	{
+		size_t new_capacity = _journal_buffer_size + _journal_buffer_size / 2;
+		if (new_capacity < 8) {
+			new_capacity = 8;
+		}
+		journal_entry* new_journal = new journal_entry[new_capacity];
+		for (size_t i = 0; i < _journal_buffer_size; ++i) {
+			new_journal[i] = _journal_buffer[i];
+		}
+		delete[] _journal_buffer;
+		_journal_buffer      = new_journal;
+		_journal_buffer_size = new_capacity;
+		this->set_new_journal(_journal_buffer, _journal_buffer_size);
+	}
+
 private:
-	T  _initialValue;
-	T  _nullValue;
-	T* _buffer;
+	T              _initialValue;
+	T*             _buffer;
+	journal_entry* _journal_buffer      = nullptr;
+	size_t         _journal_buffer_size = 0;
 };
 
 template<typename T>
@@ -569,27 +661,80 @@ inline bool basic_restorable_array<T>::can_be_migrated() const
 }
 
 template<typename T>
-inline size_t basic_restorable_array<T>::snap(unsigned char* data, const snapper&) const
+inline void basic_restorable_array<T>::entry(size_t index, T& value, T& changed) const
+{
+	value   = _array[index];
+	changed = _null;
+	if (is_journaled(index)) {
+		for (size_t i = 0; i < _journal_size; ++i) {
+			if (_journal[i].index == index) {
+				value   = _journal[i].value;
+				changed = _array[index];
+				break;
+			}
+		}
+	}
+}
+
+template<typename T>
+inline size_t basic_restorable_array<T>::snap(unsigned char* data, const snapper& snapper) const
 {
 	unsigned char* ptr          = data;
 	bool           should_write = data != nullptr;
 	ptr                         = snap_write(ptr, _saved, should_write);
-	ptr                         = snap_write(ptr, _capacity, should_write);
-	ptr                         = snap_write(ptr, _null, should_write);
+	if (snapper.compact) {
+		ptr = snap_write_varint(ptr, _capacity, should_write);
+		ptr = snap_write(ptr, _null, should_write);
+		// runs of equal entries, most indices still hold their initial value
+		size_t i = 0;
+		while (i < _capacity) {
+			T value, changed;
+			entry(i, value, changed);
+			size_t run = 1;
+			for (; i + run < _capacity; ++run) {
+				T next_value, next_changed;
+				entry(i + run, next_value, next_changed);
+				if (next_value != value || next_changed != changed) {
+					break;
+				}
+			}
+			ptr = snap_write_varint(ptr, run, should_write);
+			ptr = snap_write(ptr, value, should_write);
+			ptr = snap_write(ptr, changed, should_write);
+			i += run;
+		}
+		return static_cast<size_t>(ptr - data);
+	}
+	ptr = snap_write(ptr, _capacity, should_write);
+	ptr = snap_write(ptr, _null, should_write);
+	// each index is written as value from before save() followed by the changed value or null
+	unsigned char* entries = ptr;
 	for (size_t i = 0; i < _capacity; ++i) {
 		ptr = snap_write(ptr, _array[i], should_write);
-		ptr = snap_write(ptr, _temp[i], should_write);
+		ptr = snap_write(ptr, _null, should_write);
+	}
+	if (should_write) {
+		for (size_t i = 0; i < _journal_size; ++i) {
+			const journal_entry& j     = _journal[i];
+			unsigned char*       entry = entries + j.index * 2 * sizeof(T);
+			entry                      = snap_write(entry, j.value, true);
+			snap_write(entry, _array[j.index], true);
+		}
 	}
 	return static_cast<size_t>(ptr - data);
 }
 
 template<typename T>
-inline const unsigned char* basic_restorable_array<T>::impl_snap_load_meta(const unsigned char* data
-)
+inline const unsigned char*
+    basic_restorable_array<T>::impl_snap_load_meta(const unsigned char* data, bool compact)
 {
 	auto ptr = data;
 	ptr      = snap_read(ptr, _saved);
-	ptr      = snap_read(ptr, _loaded_capacity);
+	if (compact) {
+		ptr = snap_read_varint(ptr, _loaded_capacity);
+	} else {
+		ptr = snap_read(ptr, _loaded_capacity);
+	}
 	T null;
 	ptr = snap_read(ptr, null);
 	inkAssert(null == _null, "null value is different to snapshot!");
@@ -598,40 +743,59 @@ inline const unsigned char* basic_restorable_array<T>::impl_snap_load_meta(const
 
 template<typename T>
 inline const unsigned char*
-    basic_restorable_array<T>::impl_snap_load_payload(const unsigned char* data)
+    basic_restorable_array<T>::impl_snap_load_payload(const unsigned char* data, bool compact)
 {
 	inkAssert(
 	    capacity() >= loaded_capacity(),
 	    "New config does not allow for necessary size used by this snapshot!"
 	);
-	auto ptr = data;
+	clear_journal();
+	auto   ptr = data;
+	size_t run     = 0;
+	T      value   = _null;
+	T      changed = _null;
 	for (size_t i = 0; i < loaded_capacity(); ++i) {
-		ptr = snap_read(ptr, _array[i]);
-		ptr = snap_read(ptr, _temp[i]);
+		if (! compact) {
+			ptr = snap_read(ptr, value);
+			ptr = snap_read(ptr, changed);
+		} else if (run == 0) {
+			ptr = snap_read_varint(ptr, run);
+			ptr = snap_read(ptr, value);
+			ptr = snap_read(ptr, changed);
+			inkAssert(run > 0 && i + run <= loaded_capacity(), "Corrupted restorable array snapshot");
+		}
+		--run;
+		_array[i] = value;
+		// values changed after save() go on top of the journaled old value
+		if (changed != _null) {
+			inkAssert(_saved, "Only saved arrays can contain changed values!");
+			record(i);
+			_array[i] = changed;
+		}
 	}
 	return ptr;
 }
 
 template<typename T, size_t SIZE>
 inline const unsigned char* fixed_restorable_array<
-    T, SIZE>::snap_load(const unsigned char* data, const snapshot_interface::loader&)
+    T, SIZE>::snap_load(const unsigned char* data, const snapshot_interface::loader& loader)
 {
 	auto ptr = data;
-	ptr      = base::impl_snap_load_meta(ptr);
-	ptr      = base::impl_snap_load_payload(ptr);
+	ptr      = base::impl_snap_load_meta(ptr, loader.compact());
+	ptr      = base::impl_snap_load_payload(ptr, loader.compact());
 	return ptr;
 }
 
 template<typename T>
 inline const unsigned char* allocated_restorable_array<
-    T>::snap_load(const unsigned char* data, const snapshot_interface::loader&)
+    T>::snap_load(const unsigned char* data, const snapshot_interface::loader& loader)
 {
 	auto ptr = data;
-	ptr      = base::impl_snap_load_meta(ptr);
+	ptr      = base::impl_snap_load_meta(ptr, loader.compact());
 	if (base::buffer() == nullptr || base::capacity() < base::loaded_capacity()) {
 		resize(base::loaded_capacity());
 	}
-	ptr = base::impl_snap_load_payload(ptr);
+	ptr = base::impl_snap_load_payload(ptr, loader.compact());
 	return ptr;
 }
 
@@ -0,0 +1,140 @@
+/* Copyright (c) 2024 Julian Benda
+ *
+ * This file is part of inkCPP which is released under MIT license.
+ * See file LICENSE.txt or go to
+ * https://github.com/JBenda/inkcpp for full license details.
+ */
+#include "compression.h"
+
+#include "snapshot_interface.h"
+
+#include <cstring>
+
+namespace ink::runtime::internal
+{
+namespace
+{
+	// shorter matches are stored as literals
+	constexpr size_t min_match = 4;
+	// last position of each hashed 4 byte sequence
+	constexpr size_t hash_bits  = 12;
+	constexpr size_t table_size = size_t(1) << hash_bits;
+
+	size_t slot(const unsigned char* data)
+	{
+		uint32_t key;
+		memcpy(&key, data, sizeof(key));
+		return (key * 2654435761U) >> (32 - hash_bits);
+	}
+} // namespace
+
+size_t compressed_bound(size_t length)
+{
+	// a match is only taken if its token is not longer than the bytes it replaces, so only the
+	// length and the literal count of the last token are added
+	return snapshot_interface::varint_size(length) + length + snapshot_interface::max_varint_size;
+}
+
+size_t compress_chunk(const unsigned char* data, size_t length, unsigned char* out)
+{
+	unsigned char* ptr   = snapshot_interface::snap_write_varint(out, length, true);
+	uint32_t*      table = new uint32_t[table_size];
+	for (size_t i = 0; i < table_size; ++i) {
+		table[i] = ~0U;
+	}
+
+	auto literals = [&](size_t start, size_t end) {
+		ptr = snapshot_interface::snap_write_varint(ptr, end - start, true);
+		ptr = snapshot_interface::snap_write(ptr, data + start, end - start, true);
+	};
+
+	size_t pending = 0; // start of bytes not yet written
+	size_t pos     = 0;
+	while (pos + min_match <= length) {
+		uint32_t& entry = table[slot(data + pos)];
+		uint32_t  from  = entry;
+		entry           = static_cast<uint32_t>(pos);
+		if (from == ~0U || memcmp(data + from, data + pos, min_match) != 0) {
+			++pos;
+			continue;
+		}
+
+		size_t match = min_match;
+		while (pos + match < length && data[from + match] == data[pos + match]) {
+			++match;
+		}
+		const size_t distance = pos - from;
+		const size_t cost     = snapshot_interface::varint_size(pos - pending)
+		                  + snapshot_interface::varint_size(match - min_match)
+		                  + snapshot_interface::varint_size(distance);
+		if (cost > match) {
+			++pos;
+			continue;
+		}
+
+		literals(pending, pos);
+		ptr = snapshot_interface::snap_write_varint(ptr, match - min_match, true);
+		ptr = snapshot_interface::snap_write_varint(ptr, distance, true);
+		pos += match;
+		pending = pos;
+	}
+	if (pending < length) {
+		literals(pending, length);
+	}
+
+	delete[] table;
+	return static_cast<size_t>(ptr - out);
+}
+
+const unsigned char* expand_chunk(
+    const unsigned char* data, const unsigned char* end, unsigned char*& out,
+    const unsigned char* out_end
+)
+{
+	size_t               length;
+	const unsigned char* ptr = snapshot_interface::snap_read_varint(data, end, length);
+	if (ptr == nullptr || length > static_cast<size_t>(out_end - out)) {
+		return nullptr;
+	}
+
+	unsigned char*       dst    = out;
+	const unsigned char* target = out + length;
+	while (dst < target) {
+		size_t count;
+		ptr = snapshot_interface::snap_read_varint(ptr, end, count);
+		if (ptr == nullptr || count > static_cast<size_t>(target - dst)
+		    || count > static_cast<size_t>(end - ptr)) {
+			return nullptr;
+		}
+		memcpy(dst, ptr, count);
+		dst += count;
+		ptr += count;
+		if (dst == target) {
+			break;
+		}
+
+		size_t match, distance;
+		ptr = snapshot_interface::snap_read_varint(ptr, end, match);
+		if (ptr == nullptr) {
+			return nullptr;
+		}
+		ptr = snapshot_interface::snap_read_varint(ptr, end, distance);
+		if (ptr == nullptr) {
+			return nullptr;
+		}
+		match += min_match;
+		if (distance == 0 || distance > static_cast<size_t>(dst - out)
+		    || match > static_cast<size_t>(target - dst)) {
+			return nullptr;
+		}
+		// byte by byte, the match may overlap the bytes it produces
+		const unsigned char* from = dst - distance;
+		for (size_t i = 0; i < match; ++i) {
+			dst[i] = from[i];
+		}
+		dst += match;
+	}
+	out = dst;
+	return ptr;
+}
+} // namespace ink::runtime::internal
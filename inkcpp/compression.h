@@ -0,0 +1,32 @@
+/* Copyright (c) 2024 Julian Benda
+ *
+ * This file is part of inkCPP which is released under MIT license.
+ * See file LICENSE.txt or go to
+ * https://github.com/JBenda/inkcpp for full license details.
+ */
+#pragma once
+
+#include "config.h"
+#include "system.h"
+
+namespace ink::runtime::internal
+{
+// LZ77 style block compression used for compact snapshots.
+//
+// A chunk starts with its uncompressed length followed by tokens: a number of literal bytes, the
+// literals and then a match, which repeats bytes already written. Chunks know their length, so
+// they can be written one after another and expanded in the same order.
+
+// Upper bound of the size of the chunk compressing length bytes
+size_t compressed_bound(size_t length);
+
+// Compresses length bytes of data into a chunk at out, returns the size of the chunk
+size_t compress_chunk(const unsigned char* data, size_t length, unsigned char* out);
+
+// Expands the chunk at data into out and advances out behind the expanded bytes.
+// Returns the end of the chunk, nullptr if the chunk is corrupted or does not fit before out_end.
+const unsigned char* expand_chunk(
+    const unsigned char* data, const unsigned char* end, unsigned char*& out,
+    const unsigned char* out_end
+);
+} // namespace ink::runtime::internal
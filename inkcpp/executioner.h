@@ -14,17 +14,14 @@
 /// Therefore it is required that each argument has a unique type, so that the
 /// order won't matter.
 ///
-/// When call an operation the executioner iterates through all commands and
-/// after find an command match.
-/// Then pop arguments from the stack as defined in `command_num_args`.
-/// After this iterate through the implementations of that command for different
-/// type until it found the correct type, than execute the operation.
-/// The search is O(n), but the list is only populated with commands which have
-/// at least one implementation, also per command only types listed for which
-/// the command is implemented.
-///
-/// Improvements: The executioner -> typed_executer could be O(1) when using a
-/// look up table.
+/// The operations are stored in a chain of executer_imp (one per command) and
+/// typed_executer (one per type the command is implemented for). The search
+/// through this chain happens at compile time: a table indexed by command
+/// holds a function per command, which pops the arguments as defined in
+/// `command_num_args` and determines the common type of them with the
+/// casting matrix. A second table indexed by command and that type holds
+/// the function calling the operation. So each call costs two look ups
+/// instead of a search through all commands and types.
 
 #include "system.h"
 #include "value.h"
@@ -72,12 +69,14 @@ public:
 	{
 	}
 
-	void operator()(value_type t, basic_eval_stack& s, value* v)
+	// operation implementing the command for type t
+	template<value_type t>
+	auto& get()
 	{
-		if (t == ty) {
-			_op(s, v);
+		if constexpr (t == ty) {
+			return _op;
 		} else {
-			_typed_exe(t, s, v);
+			return _typed_exe.template get<t>();
 		}
 	}
 
@@ -98,11 +97,6 @@ public:
 	typed_executer(const T&)
 	{
 	}
-
-	void operator()(value_type, basic_eval_stack&, value*)
-	{
-		inkFail("Operation for value not supported!");
-	}
 };
 
 /**
@@ -140,23 +134,14 @@ public:
 	{
 	}
 
-	void operator()(Command c, basic_eval_stack& s)
+	// operations of command c
+	template<Command c>
+	typed_executer<c>& get()
 	{
-		if (c == cmd) {
-			static constexpr size_t N = command_num_args(cmd);
-			if constexpr (N == 0) {
-				value_type ty = casting::common_base<0>(nullptr);
-				_typed_exe(ty, s, nullptr);
-			} else {
-				value args[N];
-				for (int i = command_num_args(cmd) - 1; i >= 0; --i) {
-					args[i] = s.pop();
-				}
-				value_type ty = casting::common_base<N>(args);
-				_typed_exe(ty, s, args);
-			}
+		if constexpr (c == cmd) {
+			return _typed_exe;
 		} else {
-			_exe(c, s);
+			return _exe.template get<c>();
 		}
 	}
 
@@ -174,10 +159,109 @@ public:
 	executer_imp(const T&)
 	{
 	}
+};
+
+using operations = executer_imp<Command::OP_BEGIN>;
+
+/// calls the operation of cmd for type ty, if there is one
+template<Command cmd, value_type ty>
+void run_operation(operations& ops, basic_eval_stack& s, value* args)
+{
+	if constexpr (typed_executer<cmd>::enabled && operation<cmd, ty>::enabled) {
+		ops.template get<cmd>().template get<ty>()(s, args);
+	} else {
+		inkFail("Operation for value not supported!");
+	}
+}
+
+/// Operation per command and common type of the arguments
+struct operation_table {
+	using entry = void (*)(operations&, basic_eval_stack&, value*);
+
+	static constexpr size_t num_commands
+	    = static_cast<size_t>(Command::OP_END) - static_cast<size_t>(Command::OP_BEGIN);
+	static constexpr size_t num_types = static_cast<size_t>(value_type::OP_END);
+
+	entry entries[num_commands][num_types];
+
+	constexpr operation_table()
+	    : entries{}
+	{
+		fill<0>();
+	}
+
+	template<size_t C>
+	constexpr void fill()
+	{
+		fill_types<C, 0>();
+		if constexpr (C + 1 < num_commands) {
+			fill<C + 1>();
+		}
+	}
+
+	template<size_t C, size_t T>
+	constexpr void fill_types()
+	{
+		entries[C][T] = &run_operation<Command::OP_BEGIN + C, static_cast<value_type>(T)>;
+		if constexpr (T + 1 < num_types) {
+			fill_types<C, T + 1>();
+		}
+	}
+};
+
+static constexpr operation_table operation_lut{};
+
+/// pops the arguments of cmd and calls the operation for their common type
+template<Command cmd>
+void run_command(operations& ops, basic_eval_stack& s)
+{
+	if constexpr (typed_executer<cmd>::enabled) {
+		constexpr size_t N   = command_num_args(cmd);
+		constexpr size_t row = static_cast<size_t>(cmd) - static_cast<size_t>(Command::OP_BEGIN);
+		if constexpr (N == 0) {
+			value_type ty = casting::common_base<0>(nullptr);
+			operation_lut.entries[row][static_cast<size_t>(ty)](ops, s, nullptr);
+		} else {
+			value args[N];
+			for (int i = command_num_args(cmd) - 1; i >= 0; --i) {
+				args[i] = s.pop();
+			}
+			value_type ty = casting::common_base<N>(args);
+			if (ty >= value_type::OP_END) {
+				inkFail("Operation for value not supported!");
+				return;
+			}
+			operation_lut.entries[row][static_cast<size_t>(ty)](ops, s, args);
+		}
+	} else {
+		inkFail("requested command was not found!");
+	}
+}
+
+/// Function per command
+struct command_table {
+	using entry = void (*)(operations&, basic_eval_stack&);
+
+	entry entries[operation_table::num_commands];
+
+	constexpr command_table()
+	    : entries{}
+	{
+		fill<0>();
+	}
 
-	void operator()(Command, basic_eval_stack&) { inkFail("requested command was not found!"); }
+	template<size_t C>
+	constexpr void fill()
+	{
+		entries[C] = &run_command<Command::OP_BEGIN + C>;
+		if constexpr (C + 1 < operation_table::num_commands) {
+			fill<C + 1>();
+		}
+	}
 };
 
+static constexpr command_table command_lut{};
+
 /**
  * @brief Class which instantiates all operations and give access to them.
  */
@@ -201,9 +285,16 @@ public:
 	 * @param cmd command to execute
 	 * @param stack stack to operate on
 	 */
-	void operator()(Command cmd, basic_eval_stack& stack) { _executer(cmd, stack); }
+	void operator()(Command cmd, basic_eval_stack& stack)
+	{
+		inkAssert(
+		    cmd >= Command::OP_BEGIN && cmd < Command::OP_END, "requested command was not found!"
+		);
+		command_lut
+		    .entries[static_cast<size_t>(cmd) - static_cast<size_t>(Command::OP_BEGIN)](_executer, stack);
+	}
 
 private:
-	executer_imp<Command::OP_BEGIN> _executer;
+	operations _executer;
 };
 } // namespace ink::runtime::internal
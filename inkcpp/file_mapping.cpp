@@ -0,0 +1,84 @@
+/* Copyright (c) 2024 Julian Benda
+ *
+ * This file is part of inkCPP which is released under MIT license.
+ * See file LICENSE.txt or go to
+ * https://github.com/JBenda/inkcpp for full license details.
+ */
+#include "file_mapping.h"
+
+#if defined(_WIN32)
+#	ifndef WIN32_LEAN_AND_MEAN
+#		define WIN32_LEAN_AND_MEAN
+#	endif
+#	include <windows.h>
+#	define INK_FILE_MAPPING_WIN32
+#elif defined(__unix__) || defined(__APPLE__)
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#	define INK_FILE_MAPPING_POSIX
+#endif
+
+namespace ink::runtime::internal
+{
+#if defined(INK_FILE_MAPPING_POSIX)
+const unsigned char* map_file(const char* filename, size_t& length)
+{
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0) {
+		return nullptr;
+	}
+	struct stat info;
+	void*       data = MAP_FAILED;
+	if (fstat(fd, &info) == 0 && info.st_size > 0) {
+		data = mmap(nullptr, static_cast<::size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+	}
+	// the mapping stays valid after the file is closed
+	close(fd);
+	if (data == MAP_FAILED) {
+		return nullptr;
+	}
+	length = static_cast<size_t>(info.st_size);
+	return static_cast<const unsigned char*>(data);
+}
+
+void unmap_file(const unsigned char* data, size_t length)
+{
+	munmap(const_cast<unsigned char*>(data), length);
+}
+#elif defined(INK_FILE_MAPPING_WIN32)
+const unsigned char* map_file(const char* filename, size_t& length)
+{
+	HANDLE file = CreateFileA(
+	    filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr
+	);
+	if (file == INVALID_HANDLE_VALUE) {
+		return nullptr;
+	}
+	LARGE_INTEGER size;
+	HANDLE        mapping = nullptr;
+	if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	}
+	void* data = nullptr;
+	if (mapping != nullptr) {
+		data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		// the view keeps the mapping alive
+		CloseHandle(mapping);
+	}
+	CloseHandle(file);
+	if (data == nullptr) {
+		return nullptr;
+	}
+	length = static_cast<size_t>(size.QuadPart);
+	return static_cast<const unsigned char*>(data);
+}
+
+void unmap_file(const unsigned char* data, size_t) { UnmapViewOfFile(data); }
+#else
+const unsigned char* map_file(const char*, size_t&) { return nullptr; }
+
+void unmap_file(const unsigned char*, size_t) {}
+#endif
+} // namespace ink::runtime::internal
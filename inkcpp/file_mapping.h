@@ -0,0 +1,21 @@
+/* Copyright (c) 2024 Julian Benda
+ *
+ * This file is part of inkCPP which is released under MIT license.
+ * See file LICENSE.txt or go to
+ * https://github.com/JBenda/inkcpp for full license details.
+ */
+#pragma once
+
+#include "config.h"
+#include "system.h"
+
+namespace ink::runtime::internal
+{
+// Maps a file read-only into memory. Pages are only loaded when they are accessed and are shared
+// between all processes mapping the same file.
+// Returns nullptr if the file can not be mapped or the platform does not support it.
+const unsigned char* map_file(const char* filename, size_t& length);
+
+// Releases a mapping created with map_file
+void unmap_file(const unsigned char* data, size_t length);
+} // namespace ink::runtime::internal
@@ -105,6 +105,35 @@ void function_base::push_string(basic_eval_stack* stack, const char* dynamic_str
 	stack->push(value{}.set<value_type::string>(dynamic_string, true));
 }
 
+void function_base::push_string(basic_eval_stack* stack, const char* string, bool allocated)
+{
+	stack->push(value{}.set<value_type::string>(string, allocated));
+}
+
+void function_base::pop_native(
+    basic_eval_stack* stack, const native_type* types, native_arg* args, size_t count
+)
+{
+	// the last argument is on top of the stack
+	for (size_t i = count; i-- > 0;) {
+		value       val = stack->pop();
+		native_arg& arg = args[i];
+		switch (types[i]) {
+			case native_type::INT: arg.i = casting::numeric_cast<value_type::int32>(val); break;
+			case native_type::UINT: arg.u = casting::numeric_cast<value_type::uint32>(val); break;
+			case native_type::BOOL: arg.b = casting::numeric_cast<value_type::int32>(val) != 0; break;
+			case native_type::FLOAT: arg.f = casting::numeric_cast<value_type::float32>(val); break;
+			case native_type::STRING: {
+				inkAssert(val.type() == value_type::string, "Type mismatch!");
+				string_type str = val.get<value_type::string>();
+				arg.s           = str.str;
+				arg.allocated   = str.allocated;
+			} break;
+			default: inkFail("Argument type can not be read natively!");
+		}
+	}
+}
+
 char* function_base::allocate(string_table& strings, size_t len) { return strings.create(len); }
 
 // Generate template implementations for all significant types
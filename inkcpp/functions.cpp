@@ -8,47 +8,76 @@
 
 namespace ink::runtime::internal
 {
-functions::functions()
-    : _list(nullptr)
-    , _last(nullptr)
+functions::functions() { rebuild_index(); }
+
+functions::~functions()
 {
+	for (const entry& e : _entries) {
+		delete e.value;
+	}
 }
 
-functions::~functions()
+void functions::set_call_sites(const hash_t* names, uint32_t count)
 {
-	// clean list
-	while (_list) {
-		entry* toDelete = _list;
-		_list           = _list->next;
-
-		// delete both value and entry
-		delete toDelete->value;
-		delete toDelete;
+	_call_site_names = names;
+	_call_sites.resize(count);
+	for (uint32_t i = 0; i < count; ++i) {
+		_call_sites[i] = find(names[i]);
 	}
-	_list = _last = nullptr;
 }
 
 void functions::add(hash_t name, function_base* func)
 {
-	entry* current = new entry;
-	current->name  = name;
-	current->value = func;
-	current->next  = nullptr;
+	uint32_t index  = static_cast<uint32_t>(_entries.size());
+	_entries.push() = entry{name, func};
 
-	if (_list == nullptr) {
-		_list = _last = current;
+	if (_entries.size() * 2 > _index.size()) {
+		rebuild_index();
 	} else {
-		_last->next = current;
-		_last       = current;
+		const size_t mask = _index.size() - 1;
+		size_t       i    = name & mask;
+		while (_index[i] != npos) {
+			i = (i + 1) & mask;
+		}
+		_index[i] = index;
+	}
+
+	// resolve the call sites of this function, unless an earlier binding already did
+	for (size_t i = 0; i < _call_sites.size(); ++i) {
+		if (_call_site_names[i] == name && _call_sites[i] == nullptr) {
+			_call_sites[i] = func;
+		}
 	}
 }
 
-function_base* functions::find(hash_t name)
+function_base* functions::find(hash_t name) const
 {
-	// find entry
-	entry* iter = _list;
-	while (iter != nullptr && iter->name != name)
-		iter = iter->next;
-	return iter == nullptr ? nullptr : iter->value;
+	const size_t mask = _index.size() - 1;
+	for (size_t i = name & mask;; i = (i + 1) & mask) {
+		uint32_t index = _index[i];
+		if (index == npos) {
+			return nullptr;
+		}
+		if (_entries[index].name == name) {
+			return _entries[index].value;
+		}
+	}
+}
+
+void functions::rebuild_index()
+{
+	_index.resize(index_capacity(_entries.size()));
+	for (auto& i : _index) {
+		i = npos;
+	}
+
+	const size_t mask = _index.size() - 1;
+	for (uint32_t index = 0; index < _entries.size(); ++index) {
+		size_t i = _entries[index].name & mask;
+		while (_index[i] != npos) {
+			i = (i + 1) & mask;
+		}
+		_index[i] = index;
+	}
 }
 } // namespace ink::runtime::internal
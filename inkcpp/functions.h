@@ -8,33 +8,47 @@
 
 #include "functional.h"
 #include "system.h"
+#include "array.h"
 
 namespace ink::runtime::internal
 {
 class basic_eval_stack;
 
-// Stores bound functions
+// Stores bound functions.
+// A hash index gives constant time lookup by name. Additionally the function of each
+// CALL_EXTERNAL in the story is resolved when it is bound, so calls don't need a lookup at all.
 class functions
 {
 public:
 	functions();
 	~functions();
 
-	// Adds a function to the registry
+	// Names of the functions called by each call site of the story, index is the call site
+	void set_call_sites(const hash_t* names, uint32_t count);
+
+	// Adds a function to the registry, if a name is bound twice the first function is used
 	void add(hash_t name, function_base* func);
 
 	// Calls a function (if available)
-	function_base* find(hash_t name);
+	function_base* find(hash_t name) const;
+
+	// Function called at a call site, nullptr if none is bound
+	function_base* at_call_site(uint32_t call_site) const { return _call_sites[call_site]; }
 
 private:
+	static constexpr uint32_t npos = ~0U;
+
 	struct entry {
 		hash_t         name;
 		function_base* value;
-		entry*         next;
 	};
 
-	// TODO: Better than a linked list?
-	entry* _list;
-	entry* _last;
+	void rebuild_index();
+
+	managed_array<entry, true, 8>                    _entries;
+	managed_array<uint32_t, true, index_capacity(8)> _index;
+	// function of each call site, nullptr while unbound
+	managed_array<function_base*, true, 8>           _call_sites;
+	const hash_t*                                    _call_site_names = nullptr;
 };
 } // namespace ink::runtime::internal
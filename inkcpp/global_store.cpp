@@ -0,0 +1,320 @@
+/* Copyright (c) 2024 Julian Benda
+ *
+ * This file is part of inkCPP which is released under MIT license.
+ * See file LICENSE.txt or go to
+ * https://github.com/JBenda/inkcpp for full license details.
+ */
+#include "global_store.h"
+#include "string_table.h"
+#include "list_table.h"
+#include "types.h"
+
+namespace ink::runtime::internal
+{
+global_store::global_store()
+{
+	if constexpr (! dynamic) {
+		// a fixed index always uses its full capacity
+		while (_index.size() < _index.capacity()) {
+			_index.push() = npos;
+		}
+	}
+	rebuild_index();
+}
+
+void global_store::init(const hash_t* slot_names, uint32_t num_slots)
+{
+	clear();
+	for (uint32_t i = 0; i < num_slots; ++i) {
+		uint32_t index = add(slot_names[i]);
+		inkAssert(index == i, "Global variable slots must be unique!");
+	}
+}
+
+uint32_t global_store::find(hash_t name) const
+{
+	const size_t mask = _index.size() - 1;
+	for (size_t i = name & mask;; i = (i + 1) & mask) {
+		uint32_t index = _index[i];
+		if (index == npos || _entries[index].name == name) {
+			return index;
+		}
+	}
+}
+
+const value* global_store::get(hash_t name) const
+{
+	uint32_t index = find(name);
+	return index == npos ? nullptr : get_at(index);
+}
+
+const value* global_store::get_at(uint32_t index) const
+{
+	const var_entry& e = _entries[index];
+	return e.defined ? &e.data : nullptr;
+}
+
+uint32_t global_store::insert(hash_t name)
+{
+	uint32_t index = find(name);
+	return index == npos ? add(name) : index;
+}
+
+void global_store::set(hash_t name, const value& val) { set_at(insert(name), val); }
+
+void global_store::set_at(uint32_t index, const value& val)
+{
+	if (_saved) {
+		record(index);
+	}
+	var_entry& e = _entries[index];
+	e.defined    = true;
+	e.data       = val;
+}
+
+uint32_t global_store::add(hash_t name)
+{
+	inkAssert(
+	    dynamic || _entries.size() < _entries.capacity(), "Ran out of global variable storage!"
+	);
+	uint32_t   index = static_cast<uint32_t>(_entries.size());
+	var_entry& e     = _entries.push();
+	e                = var_entry{};
+	e.name           = name;
+
+	if (_entries.size() * 2 > _index.size()) {
+		rebuild_index();
+	} else {
+		const size_t mask = _index.size() - 1;
+		size_t       i    = name & mask;
+		while (_index[i] != npos) {
+			i = (i + 1) & mask;
+		}
+		_index[i] = index;
+	}
+	return index;
+}
+
+void global_store::record(uint32_t index)
+{
+	var_entry& e = _entries[index];
+	if (e.journaled) {
+		return;
+	}
+	e.journaled = true;
+	_journal.push() = journal_entry{index, e.defined, e.data};
+}
+
+void global_store::rebuild_index()
+{
+	if constexpr (dynamic) {
+		_index.resize(index_capacity(_entries.size()));
+	}
+	inkAssert(
+	    _index.size() >= _entries.size() * 2 || ! dynamic, "Global variable index is too small!"
+	);
+	for (auto& i : _index) {
+		i = npos;
+	}
+
+	const size_t mask = _index.size() - 1;
+	for (uint32_t index = 0; index < _entries.size(); ++index) {
+		size_t i = _entries[index].name & mask;
+		while (_index[i] != npos) {
+			i = (i + 1) & mask;
+		}
+		_index[i] = index;
+	}
+}
+
+void global_store::clear()
+{
+	_entries.clear();
+	_journal.clear();
+	_saved = false;
+	rebuild_index();
+}
+
+void global_store::mark_used(string_table& strings, list_table& lists) const
+{
+	auto mark = [&strings, &lists](const value& data) {
+		if (data.type() == value_type::string) {
+			strings.mark_used(data.get<value_type::string>());
+		} else if (data.type() == value_type::list) {
+			lists.mark_used(data.get<value_type::list>());
+		}
+	};
+	for (const auto& e : _entries) {
+		if (e.defined) {
+			mark(e.data);
+		}
+	}
+	// values which may come back on restore
+	for (const auto& j : _journal) {
+		if (j.defined) {
+			mark(j.data);
+		}
+	}
+}
+
+void global_store::save()
+{
+	inkAssert(! _saved, "Global variables are already saved!");
+	_saved = true;
+}
+
+void global_store::restore()
+{
+	inkAssert(_saved, "Global variables can't be restored because they are not saved!");
+	for (const auto& j : _journal) {
+		var_entry& e = _entries[j.index];
+		e.defined    = j.defined;
+		e.data       = j.data;
+		e.journaled  = false;
+	}
+	_journal.clear();
+	_saved = false;
+}
+
+void global_store::forget()
+{
+	inkAssert(_saved, "Can't forget save point because there is none!");
+	for (const auto& j : _journal) {
+		_entries[j.index].journaled = false;
+	}
+	_journal.clear();
+	_saved = false;
+}
+
+bool global_store::can_be_migrated() const
+{
+	if (_saved) {
+		return false;
+	}
+	for (const auto& e : _entries) {
+		if (e.defined && ! e.data.can_be_migrated()) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool global_store::migrate(global_store& new_store)
+{
+	inkAssert(can_be_migrated() && new_store.can_be_migrated(), "Unable to migrate globals.");
+	// move existing values to new_store, iff the variable is also defined there
+	for (const auto& e : _entries) {
+		if (! e.defined) {
+			continue;
+		}
+		uint32_t index = new_store.find(e.name);
+		if (index != npos && new_store._entries[index].defined) {
+			new_store.set_at(index, e.data);
+		}
+	}
+	// take over the layout of the new store
+	clear();
+	for (const auto& e : new_store._entries) {
+		uint32_t index = add(e.name);
+		if (e.defined) {
+			set_at(index, e.data);
+		}
+	}
+	return true;
+}
+
+size_t global_store::snap(unsigned char* data, const snapper& snapper) const
+{
+	unsigned char* ptr          = data;
+	bool           should_write = data != nullptr;
+
+	// Written like a basic_stack without threads: entries up to the save point hold the values
+	// from before save(), changed values follow behind them.
+	size_t num_saved   = 0;
+	size_t num_changed = 0;
+	for (const auto& e : _entries) {
+		if (! e.journaled && e.defined) {
+			++num_saved;
+		}
+	}
+	for (const auto& j : _journal) {
+		num_saved += j.defined ? 1 : 0;
+		num_changed += _entries[j.index].defined ? 1 : 0;
+	}
+	const size_t save = _saved ? num_saved : ~0U;
+	const size_t pos  = num_saved + num_changed;
+
+	thread_t no_thread = 0;
+	ptr                = snap_write(ptr, no_thread, should_write);
+	ptr                = snap_write(ptr, no_thread, should_write);
+	ptr                = snap_write(ptr, pos, should_write);
+	ptr                = snap_write(ptr, save, should_write);
+	ptr                = snap_write(ptr, save, should_write);
+
+	auto write = [&](hash_t name, const value& val) {
+		ptr = snap_write(ptr, name, should_write);
+		ptr += val.snap(data ? ptr : nullptr, snapper);
+	};
+	for (const auto& e : _entries) {
+		if (! e.journaled && e.defined) {
+			write(e.name, e.data);
+		}
+	}
+	for (const auto& j : _journal) {
+		if (j.defined) {
+			write(_entries[j.index].name, j.data);
+		}
+	}
+	for (const auto& j : _journal) {
+		const var_entry& e = _entries[j.index];
+		if (e.defined) {
+			write(e.name, e.data);
+		}
+	}
+	return static_cast<size_t>(ptr - data);
+}
+
+const unsigned char* global_store::snap_load(const unsigned char* ptr, const loader& loader)
+{
+	thread_t next_thread;
+	size_t   pos, jump, save;
+	ptr = snap_read(ptr, next_thread);
+	ptr = snap_read(ptr, next_thread);
+	ptr = snap_read(ptr, pos);
+	ptr = snap_read(ptr, jump);
+	ptr = snap_read(ptr, save);
+	inkAssert(jump == save, "Global variables never pop, jump and save point must be equal!");
+
+	size_t max = pos;
+	if (save != ~0U && save > max) {
+		max = save;
+	}
+
+	// drop all values, but keep the slots
+	for (auto& e : _entries) {
+		e.defined   = false;
+		e.journaled = false;
+	}
+	_journal.clear();
+	_saved = false;
+
+	for (size_t i = 0; i < max; ++i) {
+		// values behind the save point are changes made after save()
+		if (i == save) {
+			this->save();
+		}
+		hash_t name;
+		value  val;
+		ptr = snap_read(ptr, name);
+		ptr = val.snap_load(ptr, loader);
+		// skip entries nulled by forget()
+		if (name != ~0U) {
+			set(name, val);
+		}
+	}
+	if (save != ~0U && ! _saved) {
+		this->save();
+	}
+	return ptr;
+}
+} // namespace ink::runtime::internal
@@ -0,0 +1,115 @@
+/* Copyright (c) 2024 Julian Benda
+ *
+ * This file is part of inkCPP which is released under MIT license.
+ * See file LICENSE.txt or go to
+ * https://github.com/JBenda/inkcpp for full license details.
+ */
+#pragma once
+
+#include "config.h"
+#include "system.h"
+#include "value.h"
+#include "array.h"
+#include "snapshot_interface.h"
+
+namespace ink::runtime::internal
+{
+class string_table;
+class list_table;
+
+/** Storage for global variables.
+ *
+ * Story globals live at the index of the slot the compiler assigned to them, other names (list
+ * flags, variables of a migrated snapshot) are appended behind. A hash index gives constant time
+ * lookup by name.
+ *
+ * After save() the first change of each entry records the old value in a journal, restore()
+ * writes the journal back and forget() drops it. So both only cost the number of changed entries.
+ */
+class global_store : public snapshot_interface
+{
+public:
+	static constexpr uint32_t npos = ~0U;
+
+	global_store();
+
+	// Reserves one entry per story global. Index of the entry is the slot
+	void init(const hash_t* slot_names, uint32_t num_slots);
+
+	// Index of the entry with the given name or npos
+	uint32_t find(hash_t name) const;
+	// Index of the entry with the given name, adds an undefined entry if there is none
+	uint32_t insert(hash_t name);
+
+	// Get value by name or index. nullptr if the variable is not defined (yet)
+	const value* get(hash_t name) const;
+	const value* get_at(uint32_t index) const;
+
+	// Sets a variable, defining it if needed
+	void set(hash_t name, const value& val);
+	void set_at(uint32_t index, const value& val);
+
+	hash_t name_at(uint32_t index) const { return _entries[index].name; }
+
+	// Calls callback(value&) for each defined variable
+	template<typename CallbackMethod>
+	void for_each(CallbackMethod callback)
+	{
+		for (auto& e : _entries) {
+			if (e.defined) {
+				callback(e.data);
+			}
+		}
+	}
+
+	// Garbage collection
+	void mark_used(string_table&, list_table&) const;
+
+	// == Save/Restore ==
+	void save();
+	void restore();
+	void forget();
+
+	bool is_saved() const { return _saved; }
+
+	// keep values of variables still existing in new_store and drop all other
+	bool migrate(global_store& new_store);
+
+	config::statistics::container statistics() const
+	{
+		return {static_cast<int>(_entries.capacity()), static_cast<int>(_entries.size())};
+	}
+
+	// snapshot interface, same layout as a basic_stack
+	size_t               snap(unsigned char* data, const snapper&) const;
+	const unsigned char* snap_load(const unsigned char* data, const loader&);
+	bool                 can_be_migrated() const;
+
+private:
+	struct var_entry {
+		hash_t name      = 0;
+		bool   defined   = false;
+		bool   journaled = false;
+		value  data;
+	};
+
+	struct journal_entry {
+		uint32_t index;
+		bool     defined;
+		value    data;
+	};
+
+	uint32_t add(hash_t name);
+	void     record(uint32_t index);
+	void     rebuild_index();
+	void     clear();
+
+	static constexpr bool   dynamic  = config::limitGlobalVariables < 0;
+	static constexpr size_t capacity = abs(config::limitGlobalVariables);
+
+	managed_array<var_entry, dynamic, capacity>                _entries;
+	managed_array<journal_entry, dynamic, capacity>            _journal;
+	managed_array<uint32_t, dynamic, index_capacity(capacity)> _index;
+	bool                                                       _saved = false;
+};
+} // namespace ink::runtime::internal
@@ -24,6 +24,7 @@ globals_impl::globals_impl(const story_impl* story)
     , _globals_initialized(false)
 {
 	_visit_counts.resize(_num_containers);
+	_variables.init(story->global_names(), story->num_globals());
 	if (_lists) {
 		// initialize static lists
 		_lists.init_static_list_flags(_owner->lists(), _variables);
@@ -32,10 +33,11 @@ globals_impl::globals_impl(const story_impl* story)
 
 void globals_impl::visit(uint32_t container_id, bool preserve_turns)
 {
-	const int32_t existing_turns = _visit_counts[container_id].turns;
+	const visit_count existing = _visit_counts[container_id];
 	_visit_counts.set(
-	    container_id, {_visit_counts[container_id].visits + (preserve_turns ? 0 : 1),
-	                   preserve_turns ? existing_turns : 0}
+	    container_id,
+	    {existing.visits + (preserve_turns ? 0 : 1),
+	     preserve_turns ? existing.last_turn : static_cast<int32_t>(_turn_cnt)}
 	);
 }
 
@@ -46,21 +48,15 @@ uint32_t globals_impl::visits(uint32_t container_id) const
 
 uint32_t globals_impl::turns() const { return _turn_cnt; }
 
-void globals_impl::turn()
-{
-	++_turn_cnt;
-	for (size_t i = 0; i < _visit_counts.capacity(); ++i) {
-		visit_count visits = _visit_counts[i];
-		if (visits.turns != -1) {
-			visits.turns += 1;
-			_visit_counts.set(i, visits);
-		}
-	}
-}
+void globals_impl::turn() { ++_turn_cnt; }
 
 uint32_t globals_impl::turns(uint32_t container_id) const
 {
-	return _visit_counts[container_id].turns;
+	const int32_t last_turn = _visit_counts[container_id].last_turn;
+	if (last_turn == -1) {
+		return ~0U;
+	}
+	return _turn_cnt - static_cast<uint32_t>(last_turn);
 }
 
 void globals_impl::add_runner(const runner_impl* runner)
@@ -98,14 +94,23 @@ void globals_impl::remove_runner(const runner_impl* runner)
 
 void globals_impl::set_variable(hash_t name, const value& val)
 {
-	ink::optional<value> old_var   = ink::nullopt;
-	value*               p_old_var = get_variable(name);
-	if (p_old_var != nullptr) {
-		old_var = *p_old_var;
+	set_variable_at(_variables.insert(name), val);
+}
+
+void globals_impl::set_variable_at(uint32_t slot, const value& val)
+{
+	// observers get the previous value, only copy it if someone is listening
+	ink::optional<value> old_var = ink::nullopt;
+	if (_callbacks.size() > 0) {
+		const value* p_old_var = _variables.get_at(slot);
+		if (p_old_var != nullptr) {
+			old_var = *p_old_var;
+		}
 	}
 
-	_variables.set(name, val);
+	_variables.set_at(slot, val);
 
+	const hash_t name = _variables.name_at(slot);
 	for (auto& callback : _callbacks) {
 		if (callback.name == name) {
 			if (old_var.has_value()) {
@@ -119,9 +124,14 @@ void globals_impl::set_variable(hash_t name, const value& val)
 	}
 }
 
+const value* globals_impl::get_variable_at(uint32_t slot) const { return _variables.get_at(slot); }
+
 const value* globals_impl::get_variable(hash_t name) const { return _variables.get(name); }
 
-value* globals_impl::get_variable(hash_t name) { return _variables.get(name); }
+value* globals_impl::get_variable(hash_t name)
+{
+	return const_cast<value*>(_variables.get(name));
+}
 
 optional<ink::runtime::value> globals_impl::get_var(hash_t name) const
 {
@@ -134,11 +144,13 @@ optional<ink::runtime::value> globals_impl::get_var(hash_t name) const
 
 bool globals_impl::set_var(hash_t name, const ink::runtime::value& val)
 {
-	auto* var = get_variable(name);
+	const uint32_t index = _variables.find(name);
+	const value*   var   = index == global_store::npos ? nullptr : _variables.get_at(index);
 	if (! var) {
 		return false;
 	}
 	ink::runtime::value old_val = var->to_interface_value(lists());
+	value               new_var = *var;
 
 	bool ret = false;
 	if (val.type == ink::runtime::value::Type::String) {
@@ -156,11 +168,14 @@ bool globals_impl::set_var(hash_t name, const ink::runtime::value& val)
 		for (const char* i = val.get<runtime::value::Type::String>(); *i; ++i) {
 			*ptr++ = *i;
 		}
-		*ptr = 0;
-		*var = value{}.set<value_type::string>(static_cast<const char*>(new_string), true);
-		ret  = true;
+		*ptr    = 0;
+		new_var = value{}.set<value_type::string>(static_cast<const char*>(new_string), true);
+		ret     = true;
 	} else {
-		ret = var->set(val);
+		ret = new_var.set(val);
+	}
+	if (ret) {
+		_variables.set_at(index, new_var);
 	}
 
 	for (auto& callback : _callbacks) {
@@ -176,7 +191,7 @@ void globals_impl::internal_observe(hash_t name, callback_base* callback)
 {
 	_callbacks.push() = Callback{name, callback};
 	if (_globals_initialized) {
-		value* p_var = _variables.get(name);
+		const value* p_var = _variables.get(name);
 		inkAssert(
 		    p_var != nullptr,
 		    "Global variable to observe does not exists after initiliazation. This variable will "
@@ -200,6 +215,41 @@ void globals_impl::initialize_globals(runner_impl* run)
 }
 
 void globals_impl::gc()
+{
+	// lists handed out by get_var are only valid until the story continues
+	_lists.release_handouts();
+
+	if (gc_required()) {
+		collect();
+	} else {
+		++_gc_statistics.skipped;
+	}
+}
+
+bool globals_impl::gc_required() const
+{
+	const size_t allocations = _strings.allocations() + _lists.allocations();
+	if (allocations - _gc_allocations >= static_cast<size_t>(config::gcThreshold)) {
+		return true;
+	}
+
+	// fixed size tables must not run full between two collections
+	if constexpr (config::limitStringTable >= 0) {
+		const auto strings = _strings.statistics().string_refs;
+		if (strings.size * 2 >= strings.capacity) {
+			return true;
+		}
+	}
+	if constexpr (config::maxLists >= 0) {
+		const auto lists = _lists.statistics().lists;
+		if (lists.size * 2 >= lists.capacity) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void globals_impl::collect()
 {
 	// Mark all strings as unused
 	_strings.clear_usage();
@@ -216,8 +266,12 @@ void globals_impl::gc()
 	_variables.mark_used(_strings, _lists);
 
 	// run garbage collection
-	_strings.gc();
-	_lists.gc();
+	size_t freed = _strings.gc();
+	freed += _lists.gc();
+
+	_gc_allocations = _strings.allocations() + _lists.allocations();
+	_gc_statistics.collections += 1;
+	_gc_statistics.freed += static_cast<int>(freed);
 }
 
 void globals_impl::save()
@@ -238,7 +292,26 @@ void globals_impl::forget()
 	_variables.forget();
 }
 
-snapshot* globals_impl::create_snapshot() const { return new snapshot_impl(*this); }
+snapshot* globals_impl::create_snapshot() const
+{
+	return new snapshot_impl(*this, config::compactSnapshots);
+}
+
+snapshot* globals_impl::create_snapshot(bool compact) const
+{
+	return new snapshot_impl(*this, compact);
+}
+
+snapshot* globals_impl::create_delta_snapshot(const snapshot& base) const
+{
+	snapshot_impl current(*this, config::compactSnapshots);
+	return new snapshot_delta(base, current);
+}
+
+void globals_impl::write_snapshot(snapshot::sink& out, bool compact) const
+{
+	snapshot_impl::write(*this, out, compact);
+}
 
 bool globals_impl::can_be_migrated() const
 {
@@ -257,7 +330,10 @@ size_t globals_impl::snap(unsigned char* data, const snapper& snapper) const
 	ptr = snap_write(ptr, _turn_cnt, data != nullptr);
 	ptr += _visit_counts.snap(data ? ptr : nullptr, snapper);
 	for (unsigned i = 0; i < _visit_counts.capacity(); ++i) {
-		ptr = snap_write(ptr, _owner->container_data(i)._hash, data != nullptr);
+		// compact snapshots only need to find visited containers again
+		if (! snapper.compact || _visit_counts[i] != visit_count()) {
+			ptr = snap_write(ptr, _owner->container_data(i)._hash, data != nullptr);
+		}
 	}
 	ptr += _strings.snap(data ? ptr : nullptr, snapper);
 	ptr += _lists.snap(data ? ptr : nullptr, snapper);
@@ -271,16 +347,27 @@ const unsigned char* globals_impl::snap_load(const unsigned char* ptr, const loa
 	ptr                  = snap_read(ptr, _turn_cnt);
 	ptr                  = _visit_counts.snap_load(ptr, loader);
 	size_t old_capacity  = _visit_counts.loaded_capacity();
+	if (loader.version < 2) {
+		// older snapshots store the turns since the last visit instead of the turn of the visit
+		const int32_t turn_cnt = static_cast<int32_t>(_turn_cnt);
+		_visit_counts.transform([turn_cnt](visit_count& vc) {
+			if (vc.last_turn != -1) {
+				vc.last_turn = turn_cnt - vc.last_turn;
+			}
+		});
+	}
 	// shuffle values if needed
+	visit_count* old_visit_counts = nullptr;
 	if (loader.migratable) {
+		old_visit_counts = new visit_count[old_capacity];
+		for (size_t i = 0; i < old_capacity; ++i) {
+			old_visit_counts[i] = _visit_counts[i];
+		}
 		// extend array if needed
 		if (_visit_counts.capacity() < _owner->num_containers()) {
 			_visit_counts.resize(_owner->num_containers());
 		}
-		_visit_counts.save();
-		for (size_t i = 0; i < old_capacity; ++i) {
-			_visit_counts.set(i, visit_count());
-		}
+		_visit_counts.clear(visit_count());
 	}
 
 	inkAssert(
@@ -288,6 +375,10 @@ const unsigned char* globals_impl::snap_load(const unsigned char* ptr, const loa
 	    "Missmatching number of tracked containers."
 	);
 	for (size_t i = 0; i < old_capacity; ++i) {
+		if (loader.compact()
+		    && (loader.migratable ? old_visit_counts[i] : _visit_counts[i]) == visit_count()) {
+			continue;
+		}
 		hash_t path;
 		ptr                      = snap_read(ptr, path);
 		container_t c_id         = ~0U;
@@ -301,12 +392,12 @@ const unsigned char* globals_impl::snap_load(const unsigned char* ptr, const loa
 			inkAssert(c_id == i, "tracked containere are not allowed to move, expect we migrate");
 		} else {
 			if (found) {
-				_visit_counts.set(c_id, _visit_counts.get_old(i));
+				_visit_counts.set(c_id, old_visit_counts[i]);
 			}
 		}
 	}
 	if (loader.migratable) {
-		_visit_counts.forget();
+		delete[] old_visit_counts;
 		_visit_counts.resize(_num_containers);
 	}
 	inkAssert(
@@ -348,7 +439,8 @@ bool globals_impl::migrate_new_globals(
 config::statistics::global globals_impl::statistics() const
 {
 	return {
-	    _variables.statistics(), _callbacks.statistics(), _lists.statistics(), _strings.statistics()
+	    _variables.statistics(), _callbacks.statistics(), _lists.statistics(), _strings.statistics(),
+	    _gc_statistics
 	};
 }
 
@@ -13,7 +13,7 @@
 #include "string_table.h"
 #include "list_table.h"
 #include "list_impl.h"
-#include "stack.h"
+#include "global_store.h"
 #include "snapshot_impl.h"
 #include "functional.h"
 
@@ -57,6 +57,9 @@ public:
 	}
 
 	snapshot* create_snapshot() const override;
+	snapshot* create_snapshot(bool compact) const override;
+	snapshot* create_delta_snapshot(const snapshot& base) const override;
+	void      write_snapshot(snapshot::sink& out, bool compact) const override;
 
 protected:
 	optional<ink::runtime::value> get_var(hash_t name) const override;
@@ -65,7 +68,7 @@ protected:
 
 public:
 	// Records a visit to a container.
-	// If preserve_turns is true the existing turns-since counter is kept intact
+	// If preserve_turns is true the turn of the last visit is kept intact
 	// (used during snapshot migration to avoid clobbering the restored value).
 	void visit(uint32_t container_id, bool preserve_turns = false);
 
@@ -92,6 +95,10 @@ public:
 	const value* get_variable(hash_t name) const;
 	value*       get_variable(hash_t name);
 
+	// sets/gets a global variable by the slot assigned to it by the compiler
+	void         set_variable_at(uint32_t slot, const value&);
+	const value* get_variable_at(uint32_t slot) const;
+
 	// checks if globals are initialized
 	bool are_globals_initialized() const { return _globals_initialized; }
 
@@ -107,8 +114,12 @@ public:
 	list_table& lists() { return _lists; }
 
 	// run garbage collection
+	// Called at the end of each line, collects garbage once config::gcThreshold is reached
 	void gc();
 
+	// Full garbage collection of strings and lists
+	void collect() override;
+
 	// == Save/Restore ==
 	void save();
 	void restore();
@@ -123,13 +134,14 @@ private:
 	uint32_t _turn_cnt = 0;
 
 	// Visit count array
+	// turns since the last visit are derived from _turn_cnt, so passing a turn touches no entry
 	struct visit_count {
-		uint32_t visits = 0;
-		int32_t  turns  = -1;
+		uint32_t visits    = 0;
+		int32_t  last_turn = -1;
 
 		bool operator==(const visit_count& vc) const
 		{
-			return visits == vc.visits && turns == vc.turns;
+			return visits == vc.visits && last_turn == vc.last_turn;
 		}
 
 		bool operator!=(const visit_count& vc) const { return ! (*this == vc); }
@@ -155,9 +167,13 @@ private:
 	mutable string_table _strings;
 	mutable list_table   _lists;
 
-	// Implemented as a stack (slow lookup) because it has save/restore functionality.
-	// If I could create an avl tree with save/restore, that'd be great but seems super complex.
-	internal::stack < abs(config::limitGlobalVariables), config::limitGlobalVariables<0> _variables;
+	// Garbage collection bookkeeping
+	bool                                   gc_required() const;
+	size_t                                 _gc_allocations = 0; // allocations at the last collection
+	config::statistics::garbage_collection _gc_statistics  = {0, 0, 0};
+
+	// Global variables, indexed by the slots the compiler assigned
+	global_store _variables;
 
 	struct Callback {
 		hash_t         name;
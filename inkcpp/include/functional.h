@@ -117,6 +117,45 @@ private:
 	F functor;
 };
 
+// Argument types external functions can receive without conversion to ink::runtime::value
+enum class native_type : char {
+	NONE,
+	INT,
+	UINT,
+	BOOL,
+	FLOAT,
+	STRING,
+};
+
+template<typename T>
+constexpr native_type native_type_of = native_type::NONE;
+template<>
+constexpr native_type native_type_of<int32_t> = native_type::INT;
+template<>
+constexpr native_type native_type_of<uint32_t> = native_type::UINT;
+template<>
+constexpr native_type native_type_of<bool> = native_type::BOOL;
+template<>
+constexpr native_type native_type_of<float> = native_type::FLOAT;
+template<>
+constexpr native_type native_type_of<double> = native_type::FLOAT;
+template<>
+constexpr native_type native_type_of<const char*> = native_type::STRING;
+
+// Argument read from the stack, the active member depends on the requested native_type
+struct native_arg {
+	union {
+		int32_t     i;
+		uint32_t    u;
+		bool        b;
+		float       f;
+		const char* s;
+	};
+
+	// for strings: if s is owned by the string table
+	bool allocated;
+};
+
 // base function container with virtual callback methods
 class function_base
 {
@@ -156,6 +195,29 @@ protected:
 
 	// string special push
 	static void push_string(basic_eval_stack* stack, const char* dynamic_string);
+	static void push_string(basic_eval_stack* stack, const char* string, bool allocated);
+
+	// pops count arguments at once and converts them to the given types.
+	// types[0] and args[0] belong to the first argument
+	static void pop_native(
+	    basic_eval_stack* stack, const native_type* types, native_arg* args, size_t count
+	);
+
+	template<typename T>
+	static T get_native(const native_arg& arg)
+	{
+		if constexpr (native_type_of<T> == native_type::INT) {
+			return arg.i;
+		} else if constexpr (native_type_of<T> == native_type::UINT) {
+			return arg.u;
+		} else if constexpr (native_type_of<T> == native_type::BOOL) {
+			return arg.b;
+		} else if constexpr (native_type_of<T> == native_type::FLOAT) {
+			return static_cast<T>(arg.f);
+		} else {
+			return arg.s;
+		}
+	}
 
 	// used to hide string_table definitions
 	static char* allocate(string_table& strings, ink::size_t len);
@@ -177,7 +239,12 @@ public:
 	    basic_eval_stack* stack, size_t length, string_table& strings, list_table& lists
 	) override
 	{
-		call(stack, length, strings, lists, GenSeq<traits::arity>());
+		if constexpr (is_native_call(GenSeq<traits::arity>())) {
+			inkAssert(traits::arity == length, "Attempting to call functor with too few/many arguments");
+			call_native(stack, strings, GenSeq<traits::arity>());
+		} else {
+			call(stack, length, strings, lists, GenSeq<traits::arity>());
+		}
 	}
 
 private:
@@ -209,6 +276,51 @@ private:
 		}
 	}
 
+	// type of an argument as the functor takes it
+	template<int index>
+	using native_arg_type = typename remove_cvref<arg_type<index>>::type;
+
+	// if all arguments can be read without conversion to ink::runtime::value
+	template<size_t... Is>
+	static constexpr bool is_native_call(seq<Is...>)
+	{
+		return ! is_array_call()
+		    && (true && ... && (native_type_of<native_arg_type<Is>> != native_type::NONE));
+	}
+
+	// Reads all arguments in one go directly as the types of the functor
+	template<size_t... Is>
+	void call_native(basic_eval_stack* stack, string_table& strings, seq<Is...>)
+	{
+		constexpr size_t count = sizeof...(Is);
+		// one extra entry, so functions without arguments don't need an empty array
+		static constexpr native_type types[count + 1]
+		    = {native_type_of<native_arg_type<Is>>..., native_type::NONE};
+		native_arg args[count + 1];
+		if constexpr (count > 0) {
+			pop_native(stack, types, args, count);
+		}
+
+		using return_type = typename traits::return_type;
+		if constexpr (is_same<void, return_type>::value) {
+			functor(get_native<native_arg_type<Is>>(args[Is])...);
+			push_void(stack);
+		} else {
+			return_type res = functor(get_native<native_arg_type<Is>>(args[Is])...);
+			if constexpr (native_type_of<typename remove_cvref<return_type>::type>
+			              == native_type::STRING) {
+				// a string argument which is returned is already owned by the runtime
+				for (size_t i = 0; i < count; ++i) {
+					if (types[i] == native_type::STRING && args[i].s == res) {
+						push_string(stack, res, args[i].allocated);
+						return;
+					}
+				}
+			}
+			push_result(stack, strings, res);
+		}
+	}
+
 	template<size_t... Is>
 	void
 	    call(basic_eval_stack* stack, size_t length, string_table& strings, list_table& lists, seq<Is...>)
@@ -247,33 +359,40 @@ private:
 			} else {
 				res = functor(pop_arg<Is>(stack, lists)...);
 			}
-			if constexpr (is_string<typename traits::return_type>::value) {
-				// SPECIAL: The result of the functor is a string type
-				//  in order to store it in the inkcpp interpreter we
-				//  need to store it in our allocated string table
-				// Get string length
-				size_t len = string_handler<typename traits::return_type>::length(res);
-
-				// Get source and allocate buffer
-				char* buffer = allocate(strings, len + 1);
-				string_handler<typename traits::return_type>::src_copy(res, buffer);
-
-				// push string result
+			push_result(stack, strings, res);
+		}
+	}
+
+	// pushes the result of the functor, strings are copied into the string table
+	template<typename R>
+	void push_result(basic_eval_stack* stack, string_table& strings, R& res)
+	{
+		if constexpr (is_string<R>::value) {
+			// SPECIAL: The result of the functor is a string type
+			//  in order to store it in the inkcpp interpreter we
+			//  need to store it in our allocated string table
+			// Get string length
+			size_t len = string_handler<R>::length(res);
+
+			// Get source and allocate buffer
+			char* buffer = allocate(strings, len + 1);
+			string_handler<R>::src_copy(res, buffer);
+
+			// push string result
+			push_string(stack, buffer);
+		} else if constexpr (is_same<value, remove_cvref<R>>::value) {
+			if (res.type() == ink::runtime::value::Type::String) {
+				auto   src    = res.template get<ink::runtime::value::Type::String>();
+				size_t len    = string_handler<decltype(src)>::length(src);
+				char*  buffer = allocate(strings, len + 1);
+				string_handler<decltype(src)>::src_copy(src, buffer);
 				push_string(stack, buffer);
-			} else if constexpr (is_same<value, remove_cvref<typename traits::return_type>>::value) {
-				if (res.type() == ink::runtime::value::Type::String) {
-					auto   src    = res.template get<ink::runtime::value::Type::String>();
-					size_t len    = string_handler<decltype(src)>::length(src);
-					char*  buffer = allocate(strings, len + 1);
-					string_handler<decltype(src)>::src_copy(src, buffer);
-					push_string(stack, buffer);
-				} else {
-					push(stack, res);
-				}
 			} else {
-				// Evaluate and push the result onto the stack
 				push(stack, res);
 			}
+		} else {
+			// Evaluate and push the result onto the stack
+			push(stack, res);
 		}
 	}
 };
@@ -9,11 +9,10 @@
 #include "config.h"
 #include "types.h"
 #include "functional.h"
+#include "snapshot.h"
 
 namespace ink::runtime
 {
-class snapshot;
-
 /**
  * Represents a global store to be shared amongst ink runners.
  * Stores global variable values, visit counts, turn counts, etc.
@@ -69,11 +68,48 @@ public:
 	/** Get usage statistics for global. */
 	virtual config::statistics::global statistics() const = 0;
 
+	/** Free all strings and lists no longer used by any runner or variable.
+	 * Runs automatically at the end of a line, when enough new strings and lists were created
+	 * (see @ref ink::config::gcThreshold). Call it to release memory right away.
+	 */
+	virtual void collect() = 0;
+
 	/** create a snapshot of the current runtime state.
 	 * (inclusive all runners assoziated with this globals)
 	 */
 	virtual snapshot* create_snapshot() const = 0;
 
+	/** create a snapshot of the current runtime state in the chosen encoding.
+	 * Compact snapshots store ids as varints and runs of equal visit counts, and compress the
+	 * result. They are smaller, but take longer to create and load.
+	 * @ref create_snapshot() uses @ref ink::config::compactSnapshots.
+	 * @param compact use the compact encoding
+	 */
+	virtual snapshot* create_snapshot(bool compact) const = 0;
+
+	/** create a snapshot which only contains the changes since base.
+	 * The data of the returned snapshot is meant to be stored, it can not be loaded directly. Use
+	 * @ref ink::runtime::snapshot::from_delta() with the same base to get the full snapshot back.
+	 * The delta is computed over the data of the snapshots. With @ref
+	 * ink::config::compactSnapshots that data is compressed, so small changes of the state can
+	 * change large parts of it and the delta gets a lot bigger.
+	 * @param base earlier snapshot of this globals
+	 */
+	virtual snapshot* create_delta_snapshot(const snapshot& base) const = 0;
+
+	/** write a snapshot of the current runtime state into a sink.
+	 * Results in the same data as @ref create_snapshot(), but each section is passed to out as
+	 * soon as it is serialized instead of building the whole snapshot in memory.
+	 * The header stores the size of every section, so globals and all runners are still measured
+	 * first: the state is traversed twice, only the memory for the whole snapshot is saved.
+	 * Compact snapshots compress each section on its own, so their data differs slightly.
+	 * Load it with @ref ink::runtime::snapshot::from_binary().
+	 * @param out receives the snapshot data
+	 * @param compact use the compact encoding, see @ref create_snapshot(bool)
+	 */
+	virtual void write_snapshot(snapshot::sink& out, bool compact = config::compactSnapshots) const
+	    = 0;
+
 	virtual ~globals_interface() = default;
 
 protected:
@@ -106,6 +106,36 @@ public:
 	 */
 	virtual const char* getline_alloc() = 0;
 
+	/**
+	 * Receives consecutive parts of a line.
+	 * The parts are not null terminated.
+	 * @sa getline(line_callback, void*)
+	 */
+	using line_callback = void (*)(const char* part, size_t length, void* context);
+
+	/**
+	 * Continue execution until the next newline, then write the output into a
+	 * caller provided buffer. Does not allocate.
+	 *
+	 * If the line does not fit, the buffer holds the truncated line and the line
+	 * is kept. The next call of any getline variant returns it again.
+	 *
+	 * @param buffer to write the null terminated line into
+	 * @param capacity size of buffer
+	 * @param needed if not nullptr, set to the size of the line including the null terminator
+	 * @retval true if the whole line was written
+	 */
+	virtual bool getline(char* buffer, size_t capacity, size_t* needed) = 0;
+
+	/**
+	 * Continue execution until the next newline, then pass the output in parts
+	 * to a callback. Does not allocate.
+	 *
+	 * @param callback called with consecutive parts of the line
+	 * @param context passed to each call of callback
+	 */
+	virtual void getline(line_callback callback, void* context) = 0;
+
 #if defined(INK_ENABLE_STL) || defined(INK_ENABLE_UNREAL)
 	/**
 	 * Execute the next line of the script.
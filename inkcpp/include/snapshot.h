@@ -10,6 +10,11 @@
 
 namespace ink::runtime
 {
+namespace internal
+{
+	class snapshot_impl;
+} // namespace internal
+
 /**
  * Container for an InkCPP runtime snapshot, which can be @ref snapshot_migration "migrated".
  * Each snapshot contains a @ref ink::runtime::globals_interface "globals store"
@@ -60,6 +65,17 @@ class snapshot
 public:
 	virtual ~snapshot(){};
 
+	/** Receives the data of a snapshot piece by piece.
+	 * @sa write(), ink::runtime::globals_interface::write_snapshot()
+	 */
+	class sink
+	{
+	public:
+		virtual ~sink() = default;
+		/** called with the next bytes of the snapshot, in order */
+		virtual void write(const void* data, size_t length) = 0;
+	};
+
 	/** Construct snapshot from blob.
 	 * Memory must be kept valid until the snapshot is deconstructed.
 	 * @param data pointer to blob
@@ -70,22 +86,45 @@ public:
 	 */
 	static snapshot* from_binary(const unsigned char* data, size_t length, bool freeOnDestroy = true);
 
+	/** Reconstruct a snapshot from a delta.
+	 * @param base snapshot the delta was created against
+	 * @param data blob of the delta, created with @ref
+	 * ink::runtime::globals_interface::create_delta_snapshot()
+	 * @param length number of bytes in the delta blob
+	 * @return newly created snapshot, nullptr if the delta does not belong to base or is corrupted
+	 */
+	static snapshot* from_delta(const snapshot& base, const unsigned char* data, size_t length);
+
 	/** access blob inside snapshot */
 	virtual const unsigned char* get_data() const        = 0;
 	/** size of blob inside snapshot */
 	virtual size_t               get_data_len() const    = 0;
+	/** pass blob inside snapshot to a sink */
+	virtual void                 write(sink& out) const  = 0;
 	/** number of runners which are stored inside this snapshot */
 	virtual size_t               num_runners() const     = 0;
 	/** if this snapshot can be migrated, if the story file changes (slightly), for details see @ref
 	 * snapshot_migration. */
 	virtual bool                 can_be_migrated() const = 0;
 
+	/** full snapshot which can be loaded, nullptr for delta snapshots. internal use only.
+	 * @private
+	 */
+	virtual const internal::snapshot_impl* loadable() const = 0;
+
 #ifdef INK_ENABLE_STL
 	/** deserialize snapshot from file.
 	 * @param filename of input file
 	 * @throws ink_exception if it fails to open the file
 	 */
 	static snapshot* from_file(const char* filename);
+	/** deserialize snapshot from a memory mapped file.
+	 * The file is mapped read-only instead of copied, falls back to @ref from_file() if the
+	 * platform can not map it.
+	 * @param filename of input file
+	 * @throws ink_exception if it fails to open the file
+	 */
+	static snapshot* from_file_mapped(const char* filename);
 	/** serialize snapshot to file
 	 * @param filename output file filename, if already exist it will be overwritten
 	 * @throws ink_exception if it fails to open the file
@@ -19,6 +19,13 @@ namespace ink::runtime
  * share globals (variables, visit counts, etc). through the
  * globals object. By default, each runner gets its own newly
  * created globals store.
+ *
+ * The story itself is not changed by running it. Runners with
+ * their own globals can run on different threads against the same
+ * story, as long as the story outlives them. A globals store and its
+ * runners, as well as a snapshot while it is loaded, must only be
+ * used by one thread at a time. This needs atomic reference counts,
+ * which are disabled by the INKCPP_NO_THREADS build option.
  * @see ink::runtime::runner_interface
  * @see ink::runtime::globals_interface
  */
@@ -39,6 +46,7 @@ public:
 	virtual globals new_globals()                                  = 0;
 	/** Reconstructs globals from snapshot
 	 * @param obj snapshot to load
+	 * @return the globals, invalid if the snapshot does not fit this story or is a delta snapshot
 	 */
 	virtual globals new_globals_from_snapshot(const snapshot& obj) = 0;
 
@@ -65,6 +73,7 @@ public:
 	 * shared global are used
 	 * @param runner_id if the snapshot was of a multiple runner one global situation load first the
 	 * global, and then each runner with global set and increasing idx
+	 * @return the runner, invalid if obj is a delta snapshot
 	 */
 	virtual runner
 	    new_runner_from_snapshot(const snapshot& obj, globals store = nullptr, unsigned runner_id = 0)
@@ -90,6 +99,19 @@ public:
 	 */
 	static story* from_file(const char* filename);
 
+	/**
+	 * Creates a new story object from a memory mapped file.
+	 *
+	 * Like @ref from_file(), but the file is mapped read-only instead of
+	 * copied into memory. Pages are only loaded when accessed, and
+	 * processes loading the same file share the memory. Falls back to
+	 * reading the file if the platform can not map it.
+	 *
+	 * @param filename filename of the binary ink data
+	 * @return new story object
+	 */
+	static story* from_file_mapped(const char* filename);
+
 	/**
 	 * Create a new story object from binary buffer
 	 *
@@ -8,6 +8,10 @@
 
 #include "system.h"
 
+#ifdef INK_ENABLE_THREADS
+#	include <atomic>
+#endif
+
 namespace ink::runtime
 {
 namespace internal
@@ -22,8 +26,14 @@ namespace internal
 
 		static void remove_reference(ref_block*&);
 
+#ifdef INK_ENABLE_THREADS
+		// runners on different threads copy pointers to the same story
+		std::atomic<size_t> references;
+		std::atomic<bool>   valid;
+#else
 		size_t references;
 		bool   valid;
+#endif
 	};
 
 	/** @private */
@@ -15,14 +15,72 @@
 #include "string_utils.h"
 #include "list_impl.h"
 #include "stack.h"
+#include "global_store.h"
 #include <limits>
 
 #ifdef INK_ENABLE_STL
 #	include <ostream>
 #endif
+#ifdef _MSC_VER
+#	include <intrin.h>
+#endif
 
 namespace ink::runtime::internal
 {
+namespace
+{
+	// Bits of an entry are stored most significant first, so the leading bit of a word belongs to
+	// the lowest flag and the trailing bit to the highest.
+	static_assert(sizeof(unsigned) == 4, "bit helpers expect 32 bit words");
+
+	int bit_count(unsigned x)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		return __builtin_popcount(x);
+#else
+		x = x - ((x >> 1) & 0x55555555U);
+		x = (x & 0x33333333U) + ((x >> 2) & 0x33333333U);
+		x = (x + (x >> 4)) & 0x0F0F0F0FU;
+		return static_cast<int>((x * 0x01010101U) >> 24);
+#endif
+	}
+
+	// @pre x != 0
+	int leading_zeros(unsigned x)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		return __builtin_clz(x);
+#elif defined(_MSC_VER)
+		unsigned long index;
+		_BitScanReverse(&index, x);
+		return 31 - static_cast<int>(index);
+#else
+		int n = 0;
+		for (; ! (x & 0x80000000U); x <<= 1) {
+			++n;
+		}
+		return n;
+#endif
+	}
+
+	// @pre x != 0
+	int trailing_zeros(unsigned x)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		return __builtin_ctz(x);
+#elif defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward(&index, x);
+		return static_cast<int>(index);
+#else
+		int n = 0;
+		for (; ! (x & 1U); x >>= 1) {
+			++n;
+		}
+		return n;
+#endif
+	}
+} // namespace
 
 void list_table::copy_lists(const data_t* src, data_t* dst)
 {
@@ -72,25 +130,187 @@ list_table::list_table(const char* data)
 		++ptr; // skip string
 	}
 	_entrySize = segmentsFromBits(_list_end.size() + _flag_names.size(), sizeof(data_t));
-	_valid     = true;
+	init_masks();
+	init_name_index();
+	_valid = true;
 }
 
-list_table::list list_table::create()
+namespace
 {
-	for (size_t i = 0; i < _entry_state.size(); ++i) {
-		if (_entry_state[i] == state::empty) {
-			_entry_state[i] = state::used;
-			memset(
-			    _data.begin() + static_cast<ptrdiff_t>(_entrySize) * static_cast<ptrdiff_t>(i), 0,
-			    _entrySize
-			);
-			return list(i);
+	template<typename Index>
+	void insert_name(Index& index, hash_t hash, int position)
+	{
+		const size_t mask = index.size() - 1;
+		size_t       i    = hash & mask;
+		// names are inserted in order, so the first match of a probe is the first name
+		while (index[i].index != -1) {
+			i = (i + 1) & mask;
+		}
+		index[i].hash  = hash;
+		index[i].index = position;
+	}
+
+	template<typename Index>
+	void reset_index(Index& index, size_t entries)
+	{
+		while (index.size() < index_capacity(entries)) {
+			index.push();
+		}
+		for (auto& e : index) {
+			e.hash  = 0;
+			e.index = -1;
+		}
+	}
+
+	bool name_equal(const char* name, size_t len, const char* candidate)
+	{
+		return candidate != nullptr && str_equal_len(name, candidate, len) && candidate[len] == 0;
+	}
+
+	// same hash as used by the lookups, hash_string differs for non ASCII characters
+	hash_t name_hash(const char* name)
+	{
+		return hash_data(reinterpret_cast<const unsigned char*>(name), c_str_len(name));
+	}
+} // namespace
+
+void list_table::init_name_index()
+{
+	reset_index(_flag_index, numFlags());
+	for (size_t i = 0; i < numFlags(); ++i) {
+		if (_flag_names[i] != nullptr) {
+			insert_name(_flag_index, name_hash(_flag_names[i]), static_cast<int>(i));
+		}
+	}
+	reset_index(_list_index, numLists());
+	for (size_t i = 0; i < numLists(); ++i) {
+		insert_name(_list_index, name_hash(_list_names[i]), static_cast<int>(i));
+	}
+}
+
+int list_table::findFlag(const char* name, size_t len, int list_id) const
+{
+	if (_flag_index.size() == 0) {
+		return -1;
+	}
+	const hash_t hash = hash_data(reinterpret_cast<const unsigned char*>(name), len);
+	const size_t mask = _flag_index.size() - 1;
+	for (size_t i = hash & mask; _flag_index[i].index != -1; i = (i + 1) & mask) {
+		const name_entry& e = _flag_index[i];
+		if (e.hash != hash || ! name_equal(name, len, _flag_names[e.index])) {
+			continue;
+		}
+		if (list_id < 0
+		    || (static_cast<size_t>(e.index) >= listBegin(list_id)
+		        && static_cast<size_t>(e.index) < _list_end[list_id])) {
+			return e.index;
+		}
+	}
+	return -1;
+}
+
+int list_table::findList(const char* name, size_t len) const
+{
+	if (_list_index.size() == 0) {
+		return -1;
+	}
+	const hash_t hash = hash_data(reinterpret_cast<const unsigned char*>(name), len);
+	const size_t mask = _list_index.size() - 1;
+	for (size_t i = hash & mask; _list_index[i].index != -1; i = (i + 1) & mask) {
+		const name_entry& e = _list_index[i];
+		if (e.hash == hash && name_equal(name, len, _list_names[e.index])) {
+			return e.index;
+		}
+	}
+	return -1;
+}
+
+int list_table::findValue(size_t lid, int value) const
+{
+	size_t begin = listBegin(lid);
+	size_t end   = _list_end[lid];
+	while (begin < end) {
+		size_t mid = begin + (end - begin) / 2;
+		if (_flag_values[mid] < value) {
+			begin = mid + 1;
+		} else {
+			end = mid;
+		}
+	}
+	return begin < _list_end[lid] && _flag_values[begin] == value ? static_cast<int>(begin) : -1;
+}
+
+size_t list_table::listOf(size_t fid) const
+{
+	// first list ending behind fid
+	size_t begin = 0;
+	size_t end   = numLists();
+	while (begin < end) {
+		size_t mid = begin + (end - begin) / 2;
+		if (_list_end[mid] <= fid) {
+			begin = mid + 1;
+		} else {
+			end = mid;
+		}
+	}
+	return begin;
+}
+
+void list_table::init_masks()
+{
+	const data_t all = ~static_cast<data_t>(0);
+	for (size_t i = 0; i < numLists(); ++i) {
+		// flags of list i occupy the bits [begin, end)
+		size_t     begin = numLists() + listBegin(i);
+		size_t     end   = numLists() + _list_end[i];
+		flag_span& span  = _list_spans.push();
+		if (begin == end) {
+			span = {1, 0, 0, 0};
+			continue;
+		}
+		span.first = begin / bits_per_data;
+		span.last  = (end - 1) / bits_per_data;
+		span.head  = all >> (begin % bits_per_data);
+		span.tail  = all << (bits_per_data - 1 - (end - 1) % bits_per_data);
+	}
+
+	for (int i = 0; i < _entrySize; ++i) {
+		_named_flags.push() = 0;
+	}
+	for (size_t i = 0; i < numFlags(); ++i) {
+		if (_flag_names[i] != nullptr) {
+			setFlag(_named_flags.data(), static_cast<int>(i));
+		}
+	}
+}
+
+bool list_table::anyFlag(const data_t* data, size_t lid) const
+{
+	const flag_span& span = _list_spans[lid];
+	for (size_t w = span.first; w <= span.last; ++w) {
+		if (data[w] & spanMask(span, w)) {
+			return true;
 		}
 	}
+	return false;
+}
+
+list_table::list list_table::create()
+{
+	if (_free_entries.size() > 0) {
+		int id = _free_entries.back();
+		_free_entries.resize(_free_entries.size() - 1);
+		_entry_state[id] = state::used;
+		++_allocations;
+		// freed entries are not cleared by gc()
+		memset(getPtr(id), 0, sizeof(data_t) * static_cast<size_t>(_entrySize));
+		return list(id);
+	}
 
 	list new_entry(_entry_state.size());
 	// TODO: initialized unused?
 	_entry_state.push() = state::used;
+	++_allocations;
 	for (int i = 0; i < _entrySize; ++i) {
 		_data.push() = 0;
 	}
@@ -102,10 +322,9 @@ list_table::list list_table::create_at(size_t idx)
 	if (idx < _entry_state.size()) {
 		if (_entry_state[idx] == state::empty) {
 			_entry_state[idx] = state::used;
-			memset(
-			    _data.begin() + static_cast<ptrdiff_t>(_entrySize) * static_cast<ptrdiff_t>(idx), 0,
-			    _entrySize
-			);
+			++_allocations;
+			memset(getPtr(idx), 0, sizeof(data_t) * static_cast<size_t>(_entrySize));
+			rebuild_free_entries();
 			return list(idx);
 		}
 		return list(-1);
@@ -117,12 +336,51 @@ list_table::list list_table::create_at(size_t idx)
 		}
 	}
 	_entry_state.push() = state::used;
+	++_allocations;
 	for (int i = 0; i < _entrySize; ++i) {
 		_data.push() = 0;
 	}
+	rebuild_free_entries();
 	return list(idx);
 }
 
+void list_table::release(list l)
+{
+	_entry_state[l.lid]   = state::empty;
+	_free_entries.push() = l.lid;
+	--_allocations;
+}
+
+list_table::list list_table::reuse_operand(list res, list operand)
+{
+	const data_t* r = getPtr(res.lid);
+	const data_t* o = getPtr(operand.lid);
+	for (int i = 0; i < _entrySize; ++i) {
+		if (r[i] != o[i]) {
+			return res;
+		}
+	}
+	release(res);
+	++_reused;
+	return operand;
+}
+
+list_table::list list_table::reuse_operand(list res, list lh, list rh)
+{
+	list shared = reuse_operand(res, lh);
+	return shared.lid == res.lid ? reuse_operand(res, rh) : shared;
+}
+
+void list_table::rebuild_free_entries()
+{
+	_free_entries.clear();
+	for (size_t i = _entry_state.size(); i-- > 0;) {
+		if (_entry_state[i] == state::empty) {
+			_free_entries.push() = static_cast<int>(i);
+		}
+	}
+}
+
 void list_table::clear_usage()
 {
 	for (state& s : _entry_state) {
@@ -139,18 +397,18 @@ void list_table::mark_used(list l)
 	}
 }
 
-void list_table::gc()
+size_t list_table::gc()
 {
+	size_t freed = 0;
 	for (size_t i = 0; i < _entry_state.size(); ++i) {
 		if (_entry_state[i] == state::unused) {
-			_entry_state[i] = state::empty;
-			data_t* entry   = getPtr(i);
-			for (int j = 0; j != _entrySize; ++j) {
-				entry[j] = 0;
-			}
+			_entry_state[i]      = state::empty;
+			_free_entries.push() = static_cast<int>(i);
+			++freed;
 		}
 	}
 	_list_handouts.clear();
+	return freed;
 }
 
 size_t list_table::toFid(list_flag e) const { return listBegin(e.list_id) + e.flag; }
@@ -188,59 +446,48 @@ size_t list_table::stringLen(const list& l) const
 	return len;
 }
 
-/// @todo check ouput order for explicit valued lists
-/// @sa list_table::write()
-char* list_table::toString(char* out, const list& l) const
+int list_table::nextFlag(const list& l, int prev) const
 {
-	char* itr = out;
-
 	const data_t* entry      = getPtr(l.lid);
-	int           last_value = 0;
-	int           last_list  = -1;
-	bool          first      = true;
+	bool          first      = prev < 0;
+	int           last_value = first ? 0 : _flag_values[static_cast<size_t>(prev)];
+	size_t        last_list  = first ? 0 : listOf(static_cast<size_t>(prev));
 	int           min_value  = 0;
 	int           min_id     = -1;
-	int           min_list   = -1;
-
-	while (1) {
-		bool change = false;
-		for (size_t i = 0; i < numLists(); ++i) {
-			if (hasList(entry, i)) {
-				for (size_t j = listBegin(i); j < _list_end[i]; ++j) {
-					if (! hasFlag(entry, j)) {
-						continue;
-					}
-					int value = _flag_values[j];
-					// the cast is ok, since if we are in the
-					// first round, `first` is true and we do not evaluate
-					// second round, `last_list` is >= 0
-					if (first || value > last_value
-					    || (value == last_value && i > static_cast<size_t>(last_list))) {
-						if (min_id == -1 || value < min_value) {
-							change    = true;
-							min_list  = i;
-							min_value = value;
-							min_id    = j;
-						}
-						break;
+
+	for (size_t i = 0; i < numLists(); ++i) {
+		if (hasList(entry, static_cast<int>(i))) {
+			for (size_t j = listBegin(i); j < _list_end[i]; ++j) {
+				if (! hasFlag(entry, static_cast<int>(j))) {
+					continue;
+				}
+				int value = _flag_values[j];
+				if (first || value > last_value || (value == last_value && i > last_list)) {
+					if (min_id == -1 || value < min_value) {
+						min_value = value;
+						min_id    = static_cast<int>(j);
 					}
+					break;
 				}
 			}
 		}
-		if (! change) {
-			break;
-		}
-		if (! first) {
+	}
+	return min_id;
+}
+
+/// @todo check ouput order for explicit valued lists
+/// @sa list_table::write()
+char* list_table::toString(char* out, const list& l) const
+{
+	char* itr = out;
+	for (int fid = nextFlag(l, -1); fid != -1; fid = nextFlag(l, fid)) {
+		if (itr != out) {
 			*itr++ = ',';
 			*itr++ = ' ';
 		}
-		first = false;
-		for (const char* c = _flag_names[min_id]; *c; ++c) {
+		for (const char* c = _flag_names[static_cast<size_t>(fid)]; *c; ++c) {
 			*itr++ = *c;
 		}
-		last_value = min_value;
-		last_list  = min_list;
-		min_id     = -1;
 	}
 	return itr;
 }
@@ -274,7 +521,7 @@ list_table::list list_table::range(list_table::list l, int min, int max)
 		}
 	}
 	if (has_any_list) {
-		return res;
+		return reuse_operand(res, l);
 	}
 	copy_lists(in, out);
 	return res;
@@ -300,7 +547,7 @@ list_table::list list_table::add(list lh, list rh)
 	for (int i = 0; i < _entrySize; ++i) {
 		o[i] = l[i] | r[i];
 	}
-	return res;
+	return reuse_operand(res, lh, rh);
 }
 
 list_table::list list_table::create_permament()
@@ -341,7 +588,7 @@ list_table::list list_table::add(list lh, list_flag rh)
 	}
 	setList(o, rh.list_id);
 	setFlag(o, toFid(rh));
-	return res;
+	return reuse_operand(res, lh);
 }
 
 list_table::list list_table::sub(list lh, list rh)
@@ -356,28 +603,21 @@ list_table::list list_table::sub(list lh, list rh)
 	}
 
 	for (size_t i = 0; i < numLists(); ++i) {
-		if (hasList(r, i)) {
-			if (hasList(l, i)) {
-				for (size_t j = listBegin(i); j < _list_end[i]; ++j) {
-					if (hasFlag(o, j)) {
-						setList(o, i);
-						active_flag = true;
-						break;
-					}
-				}
-			}
+		if (hasList(r, i) && hasList(l, i) && anyFlag(o, i)) {
+			setList(o, i);
+			active_flag = true;
 		}
 	}
 	if (active_flag) {
-		return res;
+		return reuse_operand(res, lh);
 	}
 	for (size_t i = 0; i < numLists(); ++i) {
 		if (hasList(o, i)) {
-			return res;
+			return reuse_operand(res, lh);
 		}
 	}
 	copy_lists(l, o);
-	return res;
+	return reuse_operand(res, lh);
 }
 
 list_table::list list_table::sub(list lh, list_flag rh)
@@ -389,19 +629,17 @@ list_table::list list_table::sub(list lh, list_flag rh)
 		o[i] = l[i];
 	}
 	setFlag(o, toFid(rh), false);
-	for (size_t i = listBegin(rh.list_id); i < _list_end[rh.list_id]; ++i) {
-		if (hasFlag(o, i)) {
-			return res;
-		}
+	if (anyFlag(o, rh.list_id)) {
+		return reuse_operand(res, lh);
 	}
-	setList(l, rh.list_id, false);
+	setList(o, rh.list_id, false);
 	for (size_t i = 0; i < numLists(); ++i) {
 		if (hasList(o, i)) {
 			return res;
 		}
 	}
 	copy_lists(l, o);
-	return res;
+	return reuse_operand(res, lh);
 }
 
 list_flag list_table::sub(list_flag lh, list rh)
@@ -430,13 +668,10 @@ list_table::list list_table::add(list arg, int n)
 			bool has_flag = false;
 			for (size_t j = listBegin(i); j < _list_end[i]; ++j) {
 				if (hasFlag(l, j)) {
-					int value = _flag_values[j] + n;
-					for (size_t k = j + 1; k < _list_end[i]; ++k) {
-						if (value == _flag_values[k]) {
-							setFlag(o, k);
-							has_flag = true;
-							break;
-						}
+					int k = findValue(i, _flag_values[j] + n);
+					if (k >= 0) {
+						setFlag(o, k);
+						has_flag = true;
 					}
 				}
 			}
@@ -457,14 +692,8 @@ list_flag list_table::add(list_flag arg, int n)
 	if (arg == null_flag || arg == empty_flag || arg.flag == -1) {
 		return arg;
 	}
-	int value = _flag_values[arg.flag] + n;
-	for (size_t i = listBegin(arg.list_id); i < _list_end[arg.list_id]; ++i) {
-		if (_flag_values[i] == value) {
-			arg.flag = static_cast<int16_t>(i);
-			return arg;
-		}
-	}
-	arg.flag = -1;
+	int fid  = findValue(arg.list_id, _flag_values[toFid(arg)] + n);
+	arg.flag = fid < 0 ? -1 : static_cast<int16_t>(static_cast<size_t>(fid) - listBegin(arg.list_id));
 	return arg;
 }
 
@@ -484,13 +713,10 @@ list_table::list list_table::sub(list arg, int n)
 			bool has_flag = false;
 			for (size_t j = listBegin(i); j < _list_end[i]; ++j) {
 				if (hasFlag(l, j)) {
-					int value = _flag_values[j] - n;
-					for (size_t k = j - 1; k != ~0U && k >= listBegin(i) && k != ~0U; --k) {
-						if (_flag_values[k] == value) {
-							setFlag(o, k);
-							has_flag = true;
-							break;
-						}
+					int k = findValue(i, _flag_values[j] - n);
+					if (k >= 0) {
+						setFlag(o, k);
+						has_flag = true;
 					}
 				}
 			}
@@ -525,10 +751,9 @@ int32_t list_table::count(list l) const
 	const data_t* data  = getPtr(l.lid);
 	for (size_t i = 0; i < numLists(); ++i) {
 		if (hasList(data, i)) {
-			for (size_t j = listBegin(i); j < _list_end[i]; ++j) {
-				if (_flag_names[j] != nullptr && hasFlag(data, j)) {
-					++count;
-				}
+			const flag_span& span = _list_spans[i];
+			for (size_t w = span.first; w <= span.last; ++w) {
+				count += bit_count(data[w] & _named_flags[w] & spanMask(span, w));
 			}
 		}
 	}
@@ -541,9 +766,12 @@ list_flag list_table::min(list l) const
 	const data_t* data = getPtr(l.lid);
 	for (size_t i = 0; i < numLists(); ++i) {
 		if (hasList(data, i)) {
-			for (size_t j = listBegin(i); j < _list_end[i]; ++j) {
-				if (hasFlag(data, j)) {
-					int value = _flag_values[j];
+			const flag_span& span = _list_spans[i];
+			for (size_t w = span.first; w <= span.last; ++w) {
+				data_t bits = data[w] & spanMask(span, w);
+				if (bits) {
+					size_t fid   = w * bits_per_data + leading_zeros(bits) - numLists();
+					int    value = _flag_values[fid];
 					if (res.flag < 0 || value < res.flag) {
 						res.flag    = static_cast<int16_t>(value);
 						res.list_id = static_cast<int16_t>(i);
@@ -562,9 +790,13 @@ list_flag list_table::max(list l) const
 	const data_t* data = getPtr(l.lid);
 	for (size_t i = 0; i < numLists(); ++i) {
 		if (hasList(data, i)) {
-			for (size_t j = _list_end[i] - 1; j != ~0U && j >= listBegin(i); --j) {
-				if (hasFlag(data, j)) {
-					int value = _flag_values[j];
+			const flag_span& span = _list_spans[i];
+			for (size_t w = span.last + 1; w-- > span.first;) {
+				data_t bits = data[w] & spanMask(span, w);
+				if (bits) {
+					size_t fid
+					    = w * bits_per_data + (bits_per_data - 1 - trailing_zeros(bits)) - numLists();
+					int value = _flag_values[fid];
 					if (value > res.flag) {
 						res.flag    = static_cast<int16_t>(value);
 						res.list_id = static_cast<int16_t>(i);
@@ -581,13 +813,23 @@ bool list_table::equal(list lh, list rh) const
 {
 	const data_t* l = getPtr(lh.lid);
 	const data_t* r = getPtr(rh.lid);
-	for (size_t i = 0; i < numLists(); ++i) {
-		if (hasList(l, i) != hasList(r, i)) {
+	// the list bits must match completely
+	auto flag_start = flagStartMask();
+	for (size_t w = 0; w < flag_start.segment; ++w) {
+		if (l[w] != r[w]) {
 			return false;
 		}
+	}
+	if (flag_start.segment < static_cast<size_t>(_entrySize)
+	    && (l[flag_start.segment] ^ r[flag_start.segment]) & ~flag_start.mask) {
+		return false;
+	}
+	// and the flags of the contained lists
+	for (size_t i = 0; i < numLists(); ++i) {
 		if (hasList(l, i)) {
-			for (size_t j = listBegin(i); j < _list_end[i]; ++j) {
-				if (hasFlag(l, j) != hasFlag(r, j)) {
+			const flag_span& span = _list_spans[i];
+			for (size_t w = span.first; w <= span.last; ++w) {
+				if ((l[w] ^ r[w]) & spanMask(span, w)) {
 					return false;
 				}
 			}
@@ -604,8 +846,15 @@ bool list_table::equal(list lh, list_flag rh) const
 			return false;
 		}
 	}
-	for (size_t i = listBegin(rh.list_id); i < _list_end[rh.list_id]; ++i) {
-		if (hasFlag(l, i) != (rh.flag == static_cast<int16_t>(i - listBegin(rh.list_id)))) {
+	// exactly the flag rh must be set in its list
+	const flag_span& span = _list_spans[rh.list_id];
+	size_t           bit  = numLists() + toFid(rh);
+	for (size_t w = span.first; w <= span.last; ++w) {
+		data_t expected = 0;
+		if (rh.flag >= 0 && bit / bits_per_data == w) {
+			expected = static_cast<data_t>(0x01U) << (bits_per_data - 1 - bit % bits_per_data);
+		}
+		if ((l[w] & spanMask(span, w)) != expected) {
 			return false;
 		}
 	}
@@ -620,8 +869,9 @@ list_table::list list_table::all(list arg)
 	for (size_t i = 0; i < numLists(); ++i) {
 		if (hasList(l, i)) {
 			setList(o, i);
-			for (size_t j = listBegin(i); j < _list_end[i]; ++j) {
-				setFlag(o, j);
+			const flag_span& span = _list_spans[i];
+			for (size_t w = span.first; w <= span.last; ++w) {
+				o[w] |= spanMask(span, w);
 			}
 		}
 	}
@@ -634,8 +884,9 @@ list_table::list list_table::all(list_flag arg)
 	if (arg != null_flag) {
 		data_t* o = getPtr(res.lid);
 		setList(o, arg.list_id);
-		for (size_t i = listBegin(arg.list_id); i < _list_end[arg.list_id]; ++i) {
-			setFlag(o, i);
+		const flag_span& span = _list_spans[arg.list_id];
+		for (size_t w = span.first; w <= span.last; ++w) {
+			o[w] |= spanMask(span, w);
 		}
 	}
 	return res;
@@ -649,15 +900,14 @@ list_table::list list_table::invert(list arg)
 	data_t* o   = getPtr(res.lid);
 	for (size_t i = 0; i < numLists(); ++i) {
 		if (hasList(l, i)) {
-			bool hasList = false;
-			for (size_t j = listBegin(i); j < _list_end[i]; ++j) {
-				bool have = hasFlag(l, j);
-				if (! have) {
-					hasList = true;
-					setFlag(o, j);
-				}
+			const flag_span& span = _list_spans[i];
+			data_t           any  = 0;
+			for (size_t w = span.first; w <= span.last; ++w) {
+				data_t missing = ~l[w] & spanMask(span, w);
+				o[w] |= missing;
+				any |= missing;
 			}
-			if (hasList) {
+			if (any) {
 				setList(o, i);
 			}
 		}
@@ -669,9 +919,13 @@ list_table::list list_table::invert(list_flag arg)
 {
 	list res = create();
 	if (arg != null_flag) {
-		data_t* o = getPtr(res.lid);
-		for (size_t i = listBegin(arg.list_id); i < _list_end[arg.list_id]; ++i) {
-			setFlag(o, i, arg.flag != static_cast<int16_t>(i - listBegin(arg.list_id)));
+		data_t*          o    = getPtr(res.lid);
+		const flag_span& span = _list_spans[arg.list_id];
+		for (size_t w = span.first; w <= span.last; ++w) {
+			o[w] |= spanMask(span, w);
+		}
+		if (arg.flag >= 0) {
+			setFlag(o, toFid(arg), false);
 		}
 	}
 	return res;
@@ -686,7 +940,7 @@ list_table::list list_table::intersect(list lh, list rh)
 	for (int i = 0; i < _entrySize; ++i) {
 		o[i] = l[i] & r[i];
 	}
-	return res;
+	return reuse_operand(res, lh, rh);
 }
 
 list_flag list_table::intersect(list lh, list_flag rh)
@@ -709,18 +963,25 @@ list_flag list_table::lrnd(list lh, prng& rng) const
 	const data_t* l = getPtr(lh.lid);
 	int           n = count(lh);
 	n               = rng.rand(n);
-	int count       = 0;
 	for (size_t i = 0; i < numLists(); ++i) {
 		if (hasList(l, i)) {
-			for (size_t j = listBegin(i); j < _list_end[i]; ++j) {
-				if (hasFlag(l, j)) {
-					if (count++ == n) {
-						return list_flag{
-						    static_cast<decltype(list_flag::list_id)>(i),
-						    static_cast<decltype(list_flag::flag)>(j - listBegin(i))
-						};
-					}
+			const flag_span& span = _list_spans[i];
+			for (size_t w = span.first; w <= span.last; ++w) {
+				data_t bits = l[w] & _named_flags[w] & spanMask(span, w);
+				int    cnt  = bit_count(bits);
+				if (n >= cnt) {
+					n -= cnt;
+					continue;
+				}
+				// drop the n leading flags of this word
+				for (; n > 0; --n) {
+					bits &= ~(static_cast<data_t>(0x01U) << (bits_per_data - 1 - leading_zeros(bits)));
 				}
+				size_t fid = w * bits_per_data + leading_zeros(bits) - numLists();
+				return list_flag{
+				    static_cast<decltype(list_flag::list_id)>(i),
+				    static_cast<decltype(list_flag::flag)>(fid - listBegin(i))
+				};
 			}
 		}
 	}
@@ -736,8 +997,9 @@ bool list_table::has(list lh, list rh) const
 			if (! hasList(l, i)) {
 				return false;
 			}
-			for (size_t j = listBegin(i); j < _list_end[i]; ++j) {
-				if (hasFlag(r, j) && ! hasFlag(l, j)) {
+			const flag_span& span = _list_spans[i];
+			for (size_t w = span.first; w <= span.last; ++w) {
+				if (r[w] & ~l[w] & spanMask(span, w)) {
 					return false;
 				}
 			}
@@ -750,37 +1012,22 @@ optional<list_flag> list_table::toFlag(const char* flag_name) const
 {
 
 	const char* periode = str_find(flag_name, '.');
+	int         fid     = -1;
 	if (periode) {
 		list_flag list = get_list_id(flag_name); // since flag_name is `list_name.flag_name`
 		flag_name      = periode + 1;
-		int list_begin = list.list_id == 0 ? 0 : _list_end[list.list_id - 1];
-		for (size_t i = list_begin; i != _list_end[list.list_id]; ++i) {
-			if (str_equal(flag_name, _flag_names[i])) {
-				return {
-				    list_flag{list.list_id, static_cast<int16_t>(i - list_begin)}
-				};
-			}
-		}
+		fid            = findFlag(flag_name, c_str_len(flag_name), list.list_id);
 	} else {
-		for (auto flag_itr = _flag_names.begin(); flag_itr != _flag_names.end(); ++flag_itr) {
-			if (str_equal(*flag_itr, flag_name)) {
-				size_t fid   = static_cast<size_t>(flag_itr - _flag_names.begin());
-				size_t lid   = 0;
-				int    begin = 0;
-				for (auto* list_itr = _list_end.begin(); list_itr != _list_end.end(); ++list_itr) {
-					if (*list_itr > fid) {
-						lid = static_cast<size_t>(list_itr - _list_end.begin());
-						break;
-					}
-					begin = *list_itr;
-				}
-				return {
-				    list_flag{static_cast<int16_t>(lid), static_cast<int16_t>(fid - begin)}
-				};
-			}
-		}
+		fid = findFlag(flag_name, c_str_len(flag_name), -1);
+	}
+	if (fid < 0) {
+		return nullopt;
 	}
-	return nullopt;
+	size_t  lid  = listOf(static_cast<size_t>(fid));
+	int16_t flag = static_cast<int16_t>(static_cast<size_t>(fid) - listBegin(lid));
+	return {
+	    list_flag{static_cast<int16_t>(lid), flag}
+	};
 }
 
 list_flag list_table::get_list_id(const char* list_name) const
@@ -788,10 +1035,9 @@ list_flag list_table::get_list_id(const char* list_name) const
 	using int_t        = decltype(list_flag::list_id);
 	const char* period = str_find(list_name, '.');
 	size_t      len    = period ? static_cast<size_t>(period - list_name) : c_str_len(list_name);
-	for (int_t i = 0; i < static_cast<int_t>(_list_names.size()); ++i) {
-		if (str_equal_len(list_name, _list_names[i], len)) {
-			return list_flag{i, -1};
-		}
+	int         lid    = findList(list_name, len);
+	if (lid >= 0) {
+		return list_flag{static_cast<int_t>(lid), -1};
 	}
 	inkAssert(false, "No list with name found!");
 	return null_flag;
@@ -819,7 +1065,7 @@ list_table::list list_table::redefine(list lh, list rh)
 	for (int i = 0; i < _entrySize; ++i) {
 		o[i] = r[i];
 	}
-	return res;
+	return reuse_operand(res, rh);
 }
 
 list_interface* list_table::handout_list(list l)
@@ -834,50 +1080,13 @@ list_interface* list_table::handout_list(list l)
 /// @sa list_table::toString(char*,const list&)
 std::ostream& list_table::write(std::ostream& os, list l) const
 {
-	const data_t* entry      = getPtr(l.lid);
-	int           last_value = 0;
-	int           last_list  = -1;
-	bool          first      = true;
-	int           min_value  = 0;
-	int           min_id     = -1;
-	int           min_list   = -1;
-
-	while (1) {
-		bool change = false;
-		for (size_t i = 0; i < numLists(); ++i) {
-			if (hasList(entry, static_cast<int>(i))) {
-				for (size_t j = listBegin(i); j < _list_end[i]; ++j) {
-					if (! hasFlag(entry, static_cast<int>(j))) {
-						continue;
-					}
-					int value = _flag_values[j];
-					// the cast is ok, since if we are in the
-					// first round, `first` is true and we do not evaluate
-					// second round, `last_list` is >= 0
-					if (first || value > last_value
-					    || (value == last_value && i > static_cast<size_t>(last_list))) {
-						if (min_id == -1 || value < min_value) {
-							min_value = value;
-							min_id    = j;
-							min_list  = i;
-							change    = true;
-						}
-						break;
-					}
-				}
-			}
-		}
-		if (! change) {
-			break;
-		}
+	bool first = true;
+	for (int fid = nextFlag(l, -1); fid != -1; fid = nextFlag(l, fid)) {
 		if (! first) {
 			os << ", ";
 		}
 		first = false;
-		os << _flag_names[min_id];
-		last_value = min_value;
-		last_list  = min_list;
-		min_id     = -1;
+		os << _flag_names[static_cast<size_t>(fid)];
 	}
 	return os;
 }
@@ -895,6 +1104,7 @@ const unsigned char* list_table::snap_load(const unsigned char* ptr, const loade
 {
 	ptr = _data.snap_load(ptr, loader);
 	ptr = _entry_state.snap_load(ptr, loader);
+	rebuild_free_entries();
 	return ptr;
 }
 
@@ -905,6 +1115,8 @@ config::statistics::list_table list_table::statistics() const
 	    _list_end.statistics(),
 	    _flag_names.statistics(),
 	    _entry_state.statistics(),
+	    {static_cast<int>(_allocations), static_cast<int>(_reused),
+	     static_cast<int>(_free_entries.size())},
 	};
 }
 
@@ -1051,6 +1263,7 @@ bool list_table::create_match_lut(
 	}
 	_data.clear();
 	_entry_state.clear();
+	_free_entries.clear();
 
 	// find best mapping between old and new list elements
 	//     + c_ij(value) = min(|v_i - v_j|/Rv,1)
@@ -1112,71 +1325,105 @@ bool list_table::migrate_variables(
     const list_table& old_ref_table, basic_stack& variables
 )
 {
-	// TODO: optimize: map equal permanent values (old list x -> new list x)
 	bool migration_succeeded = true;
 	variables.for_each(
-	    [&](entry& value) {
-		    list   old_list = value.data.get<value_type::list>();
-		    size_t idx      = old_list.lid;
-		    while (list_old_new_map.size() <= idx) {
-			    list_old_new_map.push() = -1;
-		    }
-		    if (list_old_new_map[idx] != -1) {
-			    value.data.set<value_type::list>(list(list_old_new_map[idx]));
-			    return;
-		    }
-		    // migrate
-		    list new_list{-1};
-		    switch (old_ref_table._entry_state[idx]) {
-			    case state::permanent: new_list = create_permament(); break;
-			    case state::used: new_list = create(); break;
-			    default: return;
-		    }
-		    list_old_new_map[idx] = new_list.lid;
-		    value.data.set<value_type::list>(new_list);
-
-		    inkAssert(new_list.lid >= 0, "Failed to create new list entry for migration.");
-		    const data_t* entry         = old_ref_table.getPtr(idx);
-		    data_t*       new_entry     = getPtr(new_list.lid);
-		    bool          migrated      = false;
-		    bool          is_empty_list = true;
-		    for (size_t i = 0; i < old_ref_table.numLists(); ++i) {
-			    if (old_ref_table.hasList(entry, i)) {
-				    bool hit      = false;
-				    is_empty_list = false;
-				    for (size_t j = old_ref_table.listBegin(i); j < old_ref_table._list_end[i]; ++j) {
-					    if (old_ref_table.hasFlag(entry, j) && old_ref_table._flag_names[j]) {
-						    migrated = false;
-						    if (list_value_matches[j] != -1) {
-							    hit      = true;
-							    migrated = true;
-							    size_t k;
-							    for (k = 0; _list_end[k] <= static_cast<size_t>(list_value_matches[j]); ++k) {}
-							    setList(new_entry, k);
-							    setFlag(new_entry, list_value_matches[j]);
-						    }
-					    }
-				    }
-				    // keep list if list has match but all values where dropped
-				    if (! hit && list_list_matches[i] != -1) {
-					    setList(new_entry, list_list_matches[i]);
-					    migrated = true;
-				    }
-			    }
-		    }
-		    // drop list
-		    if (! is_empty_list && ! migrated) {
-			    // FIXME: remove list ?
-			    // _entry_state [idx] = state::empty;
+	    [&](entry& e) {
+		    if (! migrate_variable(
+		            e.data, list_old_new_map, list_list_matches, list_value_matches, old_ref_table
+		        )) {
 			    migration_succeeded = false;
 		    }
-		    // inkAssert(migrated, "Migrating list @%d would lead to an empty list", idx);
 	    },
 	    [](const entry& v) { return v.data.type() != value_type::list; }
 	);
 	return migration_succeeded;
 }
 
+bool list_table::migrate_variables(
+    ink::runtime::internal::managed_array<int, true, 5, true>&       list_old_new_map,
+    const ink::runtime::internal::managed_array<int, true, 5, true>& list_list_matches,
+    const ink::runtime::internal::managed_array<int, true, 5, true>& list_value_matches,
+    const list_table& old_ref_table, global_store& variables
+)
+{
+	bool migration_succeeded = true;
+	variables.for_each([&](value& data) {
+		if (data.type() == value_type::list
+		    && ! migrate_variable(
+		        data, list_old_new_map, list_list_matches, list_value_matches, old_ref_table
+		    )) {
+			migration_succeeded = false;
+		}
+	});
+	return migration_succeeded;
+}
+
+bool list_table::migrate_variable(
+    value& data, ink::runtime::internal::managed_array<int, true, 5, true>& list_old_new_map,
+    const ink::runtime::internal::managed_array<int, true, 5, true>& list_list_matches,
+    const ink::runtime::internal::managed_array<int, true, 5, true>& list_value_matches,
+    const list_table&                                                old_ref_table
+)
+{
+	// TODO: optimize: map equal permanent values (old list x -> new list x)
+	list   old_list = data.get<value_type::list>();
+	size_t idx      = old_list.lid;
+	while (list_old_new_map.size() <= idx) {
+		list_old_new_map.push() = -1;
+	}
+	if (list_old_new_map[idx] != -1) {
+		data.set<value_type::list>(list(list_old_new_map[idx]));
+		return true;
+	}
+	// migrate
+	list new_list{-1};
+	switch (old_ref_table._entry_state[idx]) {
+		case state::permanent: new_list = create_permament(); break;
+		case state::used: new_list = create(); break;
+		default: return true;
+	}
+	list_old_new_map[idx] = new_list.lid;
+	data.set<value_type::list>(new_list);
+
+	inkAssert(new_list.lid >= 0, "Failed to create new list entry for migration.");
+	const data_t* entry         = old_ref_table.getPtr(idx);
+	data_t*       new_entry     = getPtr(new_list.lid);
+	bool          migrated      = false;
+	bool          is_empty_list = true;
+	for (size_t i = 0; i < old_ref_table.numLists(); ++i) {
+		if (old_ref_table.hasList(entry, i)) {
+			bool hit      = false;
+			is_empty_list = false;
+			for (size_t j = old_ref_table.listBegin(i); j < old_ref_table._list_end[i]; ++j) {
+				if (old_ref_table.hasFlag(entry, j) && old_ref_table._flag_names[j]) {
+					migrated = false;
+					if (list_value_matches[j] != -1) {
+						hit      = true;
+						migrated = true;
+						size_t k;
+						for (k = 0; _list_end[k] <= static_cast<size_t>(list_value_matches[j]); ++k) {}
+						setList(new_entry, k);
+						setFlag(new_entry, list_value_matches[j]);
+					}
+				}
+			}
+			// keep list if list has match but all values where dropped
+			if (! hit && list_list_matches[i] != -1) {
+				setList(new_entry, list_list_matches[i]);
+				migrated = true;
+			}
+		}
+	}
+	// drop list
+	if (! is_empty_list && ! migrated) {
+		// FIXME: remove list ?
+		// _entry_state [idx] = state::empty;
+		return false;
+	}
+	// inkAssert(migrated, "Migrating list @%d would lead to an empty list", idx);
+	return true;
+}
+
 void list_table::impl_init_static_list(const list_flag* permanent_lists)
 {
 	const list_flag* flags = permanent_lists;
@@ -1191,7 +1438,7 @@ void list_table::impl_init_static_list(const list_flag* permanent_lists)
 	}
 }
 
-void list_table::init_static_list_flags(const list_flag* permanent_lists, basic_stack& variables)
+void list_table::init_static_list_flags(const list_flag* permanent_lists, global_store& variables)
 {
 	impl_init_static_list(permanent_lists);
 
@@ -23,7 +23,9 @@ struct header;
 namespace ink::runtime::internal
 {
 class basic_stack;
+class global_store;
 class prng;
+class value;
 
 // TODO: move to utils
 // memory segments
@@ -79,14 +81,11 @@ public:
 			return flag;
 		}
 		inkAssert(flag.list_id >= 0, "expected flag to have a base list.");
-		for (size_t i = listBegin(static_cast<size_t>(flag.list_id));
-		     i < _list_end[static_cast<size_t>(flag.list_id)]; ++i) {
-			if (_flag_values[i] == flag.flag) {
-				flag.flag = static_cast<int16_t>(i - listBegin(static_cast<size_t>(flag.list_id)));
-				return flag;
-			}
-		}
-		flag.flag = -1;
+		int fid   = findValue(static_cast<size_t>(flag.list_id), flag.flag);
+		flag.flag = fid < 0 ? -1
+		                    : static_cast<int16_t>(
+		                          static_cast<size_t>(fid) - listBegin(static_cast<size_t>(flag.list_id))
+		                      );
 		return flag;
 	}
 
@@ -107,7 +106,14 @@ public:
 	void mark_used(list);
 
 	/// delete unused lists
-	void gc();
+	/// @return number of deleted lists
+	size_t gc();
+
+	/// invalidate lists handed out by get_var
+	void release_handouts() { _list_handouts.clear(); }
+
+	/// number of lists created so far
+	size_t allocations() const { return _allocations; }
 
 
 	// function to setup list_table
@@ -115,7 +121,7 @@ public:
 	list& add_inplace(list& lh, list_flag rh);
 
 	list_table(const char* data);
-	void init_static_list_flags(const list_flag* permanent_lists, basic_stack& variables);
+	void init_static_list_flags(const list_flag* permanent_lists, global_store& variables);
 	// binary list metadata of currently loaded list
 	bool create_match_lut(
 	    const char*                                                old_list_metadata,
@@ -129,6 +135,12 @@ public:
 	    const ink::runtime::internal::managed_array<int, true, 5, true>& list_value_matches,
 	    const list_table& old_ref_table, basic_stack& variables
 	);
+	bool migrate_variables(
+	    ink::runtime::internal::managed_array<int, true, 5, true>&       list_old_new_map,
+	    const ink::runtime::internal::managed_array<int, true, 5, true>& list_list_matches,
+	    const ink::runtime::internal::managed_array<int, true, 5, true>& list_value_matches,
+	    const list_table& old_ref_table, global_store& variables
+	);
 
 	explicit list_table()
 	    : _entrySize{0}
@@ -149,8 +161,19 @@ public:
 	 */
 	char* toString(char* out, const list& l) const;
 
+	/** Iterates the flags of a list in output order, which is ascending by value
+	 * @param l list to iterate
+	 * @param prev flag id returned by the previous call, -1 to get the first flag
+	 * @return id of the next flag, -1 if there is none
+	 * @sa flagName()
+	 */
+	int nextFlag(const list& l, int prev) const;
+
+	/** name of a flag id returned by nextFlag() */
+	const char* flagName(int fid) const { return _flag_names[static_cast<size_t>(fid)]; }
+
 	/** Finds flag id to flag name
-	 * currently used a simple O(n) serach, for the expected number of flags should this be no problem
+	 * uses a hash index over the flag names, build when loading the list metadata
 	 * @param flag_name null terminated string contaning the flag name
 	 * @return list_flag with corresponding name
 	 * @retval nullopt if no flag was found
@@ -282,6 +305,29 @@ private:
 	/** initelizes static lists defined in the story. */
 	void impl_init_static_list(const list_flag* permanent_lists);
 
+	/** migrates one list variable to the new list table.
+	 * @retval false if the list would lose all of its values
+	 */
+	bool migrate_variable(
+	    value& data, ink::runtime::internal::managed_array<int, true, 5, true>& list_old_new_map,
+	    const ink::runtime::internal::managed_array<int, true, 5, true>& list_list_matches,
+	    const ink::runtime::internal::managed_array<int, true, 5, true>& list_value_matches,
+	    const list_table&                                                old_ref_table
+	);
+
+	/** return a list created by the last operation to the free entries.
+	 * @pre nothing else holds the list
+	 */
+	void release(list);
+	/** Lists are never changed after creation, if res equals operand share the operand and release
+	 * res.
+	 * @return operand if equal, else res
+	 */
+	list reuse_operand(list res, list operand);
+	list reuse_operand(list res, list lh, list rh);
+	/// refill _free_entries from _entry_state
+	void rebuild_free_entries();
+
 	/** create a list with id == idx.
 	 * @attention used for migration only
 	 * @sa create()
@@ -365,6 +411,49 @@ private:
 
 	size_t toFid(list_flag e) const;
 
+	/// flags of one list inside an entry, as range of words with masks for the first and last word
+	struct flag_span {
+		size_t first; ///< first word, greater than last for lists without flags
+		size_t last;  ///< last word (inclusive)
+		data_t head;  ///< valid bits in the first word
+		data_t tail;  ///< valid bits in the last word
+	};
+
+	/// bits of the span in word w, with first <= w <= last
+	static data_t spanMask(const flag_span& span, size_t w)
+	{
+		data_t mask = ~static_cast<data_t>(0);
+		if (w == span.first) {
+			mask &= span.head;
+		}
+		if (w == span.last) {
+			mask &= span.tail;
+		}
+		return mask;
+	}
+
+	/// slot of the name indices, open addressing with linear probing
+	struct name_entry {
+		hash_t hash;
+		int    index; ///< position in _flag_names or _list_names, -1 if the slot is empty
+	};
+
+	/// fill _flag_index and _list_index
+	void init_name_index();
+	/// flag id of the flag with name (first len characters), only in list_id if it is >= 0, or -1
+	int  findFlag(const char* name, size_t len, int list_id) const;
+	/// id of the list with name (first len characters) or -1
+	int  findList(const char* name, size_t len) const;
+	/// flag id of the flag with value inside list lid or -1, flags are sorted by value
+	int  findValue(size_t lid, int value) const;
+	/// id of the list containing the flag
+	size_t listOf(size_t fid) const;
+
+	/// true if any flag of list lid is set in data
+	bool anyFlag(const data_t* data, size_t lid) const;
+	/// precompute _list_spans and _named_flags
+	void init_masks();
+
 	auto flagStartMask() const
 	{
 		struct {
@@ -385,11 +474,18 @@ private:
 	          segmentsFromBits(abs(config::maxListTypes) + abs(config::maxFlags), sizeof(data_t))
 	          * static_cast<int>(abs(config::maxLists))
 	    );
+	static constexpr long maxEntrySize
+	    = (config::maxListTypes < 0 || config::maxFlags < 0 ? -1 : 1)
+	    * static_cast<long>(
+	          segmentsFromBits(abs(config::maxListTypes) + abs(config::maxFlags), sizeof(data_t))
+	    );
 
 	int                                    _entrySize; ///< entry size in data_t
 	// entries (created lists)
 	managed_array<data_t, maxMemorySize>   _data;
 	managed_array<state, config::maxLists> _entry_state;
+	// ids of empty entries, the last one is reused first
+	managed_array<int, config::maxLists>   _free_entries;
 	// parse binary list metadata
 	list_table(
 	    const char* data, const ink::internal::header&, const decltype(_data)& values,
@@ -401,10 +497,24 @@ private:
 	managed_array<const char*, config::maxFlags>                    _flag_names;
 	managed_array<int, config::maxFlags>                            _flag_values;
 	managed_array<const char*, config::maxListTypes>                _list_names;
+	/// word range of each list's flags
+	managed_array<flag_span, config::maxListTypes>                  _list_spans;
+	/// entry with all flags set which have a name
+	managed_array<data_t, maxEntrySize>                             _named_flags;
+
+	static constexpr int flagIndexSize
+	    = (config::maxFlags < 0 ? -1 : 1) * static_cast<int>(index_capacity(abs(config::maxFlags)));
+	static constexpr int listIndexSize = (config::maxListTypes < 0 ? -1 : 1)
+	                                   * static_cast<int>(index_capacity(abs(config::maxListTypes)));
+	/// hash index over _flag_names and _list_names
+	managed_array<name_entry, flagIndexSize, true>                  _flag_index;
+	managed_array<name_entry, listIndexSize, true>                  _list_index;
 	/// keep track over lists accessed with get_var, and clear then at gc time
 	managed_array<list_interface, config::limitEditableLists, true> _list_handouts;
 
-	bool _valid;
+	size_t _allocations = 0;
+	size_t _reused      = 0;
+	bool   _valid;
 
 public:
 	friend class named_flag_itr;
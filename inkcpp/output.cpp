@@ -165,6 +165,18 @@ std::string basic_stream::get()
 {
 	size_t start = find_start();
 
+	// story text needs no formatting and cleaning
+	size_t length = 0;
+	if (const char* text = static_line(start, length)) {
+		std::string result;
+		result.reserve(length + 1);
+		result.append(text, length);
+		result.push_back('\n');
+		_size      = start;
+		_last_char = '\n';
+		return result;
+	}
+
 	// Move up from marker
 	bool              hasGlue = false, lastNewline = false;
 	std::stringstream str;
@@ -207,6 +219,261 @@ FString basic_stream::get()
 }
 #endif
 
+namespace
+{
+	// Collapses whitespace like clean_string<true, false> while the line is written. Needs one
+	// character look ahead, a trailing space is held back and dropped at the end.
+	template<typename Sink>
+	class line_cleaner
+	{
+	public:
+		explicit line_cleaner(Sink& sink)
+		    : _sink(sink)
+		{
+		}
+
+		void put(char c)
+		{
+			if (_has_pending) {
+				process(_pending, c, true);
+			}
+			_pending     = c;
+			_has_pending = true;
+		}
+
+		void put(const char* str)
+		{
+			while (*str) {
+				put(*str++);
+			}
+		}
+
+		// returns the last character of the cleaned line, 0 if it is empty
+		char finish()
+		{
+			if (_has_pending) {
+				process(_pending, 0, false);
+			}
+			return _last;
+		}
+
+	private:
+		void process(char c, char next, bool has_next)
+		{
+			bool space = isspace(static_cast<unsigned char>(c));
+			bool skip  = false;
+			if (_last == 0) {
+				skip = space;
+			} else if (_prev == '\n' && space) {
+				skip = true;
+			} else if (space && c != '\n') {
+				skip = has_next && isspace(static_cast<unsigned char>(next));
+			} else if (c == '\n' && _last == '\n') {
+				skip = true;
+			}
+			_prev = c;
+			if (skip) {
+				return;
+			}
+			if (_held_space) {
+				_sink.put(' ');
+				_held_space = false;
+			}
+			if (c == ' ') {
+				_held_space = true;
+			} else {
+				_sink.put(c);
+			}
+			_last = c;
+		}
+
+		Sink& _sink;
+		char  _pending     = 0;
+		bool  _has_pending = false;
+		char  _prev        = 0;
+		char  _last        = 0;
+		bool  _held_space  = false;
+	};
+
+	// writes into a fixed buffer and counts what does not fit
+	struct buffer_sink {
+		char*  buffer;
+		size_t capacity;
+		size_t length = 0;
+
+		void put(char c)
+		{
+			if (length + 1 < capacity) {
+				buffer[length] = c;
+			}
+			++length;
+		}
+	};
+
+	// collects characters and passes them in chunks to a callback
+	struct callback_sink {
+		void (*callback)(const char*, size_t, void*);
+		void*  context;
+		char   chunk[64];
+		size_t length = 0;
+
+		void put(char c)
+		{
+			if (length == sizeof(chunk)) {
+				flush();
+			}
+			chunk[length++] = c;
+		}
+
+		void flush()
+		{
+			if (length > 0) {
+				callback(chunk, length, context);
+				length = 0;
+			}
+		}
+	};
+} // namespace
+
+const char* basic_stream::static_line(size_t start, size_t& length) const
+{
+	const char* text    = nullptr;
+	bool        newline = false;
+	bool        hasGlue = false, lastNewline = false;
+	for (size_t i = start; i < _size; i++) {
+		if (should_skip(i, hasGlue, lastNewline) || ! _data[i].printable()) {
+			continue;
+		}
+		if (newline) {
+			return nullptr;
+		}
+		if (text == nullptr && _data[i].type() == value_type::string) {
+			string_type str = _data[i].get<value_type::string>();
+			if (str.allocated) {
+				return nullptr;
+			}
+			text = str.str;
+		} else if (text != nullptr && _data[i].type() == value_type::newline) {
+			newline = true;
+		} else {
+			return nullptr;
+		}
+	}
+	if (! newline) {
+		return nullptr;
+	}
+
+	// whitespace is kept only between other characters and if it is not repeated
+	size_t len = 0;
+	for (; text[len]; ++len) {
+		if (isspace(static_cast<unsigned char>(text[len]))) {
+			if (len == 0 || text[len] == '\n' || text[len + 1] == 0
+			    || isspace(static_cast<unsigned char>(text[len + 1]))) {
+				return nullptr;
+			}
+		}
+	}
+	if (len == 0) {
+		return nullptr;
+	}
+	length = len;
+	return text;
+}
+
+template<typename Sink>
+char basic_stream::write_line(size_t start, Sink& sink) const
+{
+	line_cleaner<Sink> line(sink);
+	bool               hasGlue = false, lastNewline = false;
+	for (size_t i = start; i < _size; i++) {
+		if (should_skip(i, hasGlue, lastNewline) || ! _data[i].printable()) {
+			continue;
+		}
+		switch (_data[i].type()) {
+			case value_type::string: line.put(_data[i].get<value_type::string>()); break;
+			case value_type::newline: line.put('\n'); break;
+			case value_type::list_flag:
+				inkAssert(_lists_table, "to stringify lists, we need a list_table");
+				line.put(_lists_table->toString(_data[i].get<value_type::list_flag>()));
+				break;
+			case value_type::list: {
+				inkAssert(_lists_table, "to stringify lists, we need a list_table");
+				const list_table::list& l     = _data[i].get<value_type::list>();
+				bool                    first = true;
+				for (int fid = _lists_table->nextFlag(l, -1); fid != -1;
+				     fid     = _lists_table->nextFlag(l, fid)) {
+					if (! first) {
+						line.put(", ");
+					}
+					first = false;
+					line.put(_lists_table->flagName(fid));
+				}
+			} break;
+			default: {
+				char number[32];
+				toStr(number, sizeof(number), _data[i]);
+				line.put(number);
+			}
+		}
+	}
+	return line.finish();
+}
+
+size_t basic_stream::get(char* buffer, size_t capacity)
+{
+	size_t start  = find_start();
+	size_t length = 0;
+	if (const char* text = static_line(start, length)) {
+		if (length + 1 < capacity) {
+			memcpy(buffer, text, length);
+			buffer[length]     = '\n';
+			buffer[length + 1] = 0;
+			_size              = start;
+			_last_char         = '\n';
+			return length + 2;
+		}
+	}
+
+	buffer_sink sink{buffer, capacity};
+	char        last = write_line(start, sink);
+	if (capacity > 0) {
+		buffer[sink.length < capacity ? sink.length : capacity - 1] = 0;
+	}
+	if (sink.length >= capacity) {
+		return sink.length + 1;
+	}
+
+	// Reset stream size to where we last held the marker
+	_size = start;
+	if (last != 0) {
+		_last_char = last;
+	}
+	return sink.length + 1;
+}
+
+void basic_stream::get(void (*callback)(const char*, size_t, void*), void* context)
+{
+	size_t start  = find_start();
+	size_t length = 0;
+	if (const char* text = static_line(start, length)) {
+		callback(text, length, context);
+		callback("\n", 1, context);
+		_size      = start;
+		_last_char = '\n';
+		return;
+	}
+
+	callback_sink sink{callback, context, {}};
+	char          last = write_line(start, sink);
+	sink.flush();
+
+	// Reset stream size to where we last held the marker
+	_size = start;
+	if (last != 0) {
+		_last_char = last;
+	}
+}
+
 size_t basic_stream::queued() const
 {
 	size_t start = find_start();
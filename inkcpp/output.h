@@ -66,6 +66,19 @@ namespace runtime
 			template<bool RemoveTail = true>
 			char* get_alloc(string_table&, list_table&);
 
+			/** Extract into a caller provided buffer, without allocating.
+			 * The line is only extracted if it fits into the buffer including the null terminator.
+			 * Otherwise the stream stays unchanged and the buffer holds the truncated line.
+			 * @return size needed to store the line including the null terminator
+			 */
+			size_t get(char* buffer, size_t capacity);
+
+			/** Extract without allocating by passing the line in parts to a callback
+			 * @param callback called with consecutive parts of the line, which are not null terminated
+			 * @param context passed to each call of callback
+			 */
+			void get(void (*callback)(const char*, size_t, void*), void* context);
+
 #ifdef INK_ENABLE_STL
 			// Extract into a string
 			std::string get();
@@ -138,6 +151,14 @@ namespace runtime
 			template<typename T>
 			void copy_string(const char* str, size_t& dataIter, T& output);
 
+			// If the line is just story text followed by a newline, which needs no cleaning, returns
+			// the text, which stays valid as long as the story. Otherwise nullptr
+			const char* static_line(size_t start, size_t& length) const;
+
+			// writes the cleaned line into sink, returns its last character or 0 if it is empty
+			template<typename Sink>
+			char write_line(size_t start, Sink& sink) const;
+
 		private:
 			char _last_char = '\0';
 
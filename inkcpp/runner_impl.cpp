@@ -100,6 +100,25 @@ void runner_impl::set_var<runner_impl::Scope::GLOBAL>(
 	}
 }
 
+const value* runner_impl::get_var(hash_t variableName, uint32_t slot)
+{
+	// globals can not be shadowed by temporaries, so a slot is always the global variable
+	if (slot != InvalidSlot) {
+		return _globals->get_variable_at(slot);
+	}
+	return get_var(variableName);
+}
+
+void runner_impl::set_global(uint32_t slot, const value& val, bool is_redef)
+{
+	if (is_redef) {
+		const value* src = _globals->get_variable_at(slot);
+		_globals->set_variable_at(slot, src->redefine(val, _globals->lists()));
+	} else {
+		_globals->set_variable_at(slot, val);
+	}
+}
+
 const value* runner_impl::dereference(const value& val)
 {
 	if (val.type() != value_type::value_pointer) {
@@ -331,11 +350,6 @@ void runner_impl::jump(ip_t dest, bool record_visits, bool track_knot_visit, boo
 		return;
 	}
 
-	// Discard old stack, preserving save region.
-	while (! _container.empty()) {
-		_container.pop();
-	}
-
 	// Record location and jump.
 	const uint32_t current_offset
 	    = _ptr != nullptr ? static_cast<uint32_t>(_ptr - _story->instructions()) : ~0U;
@@ -346,8 +360,11 @@ void runner_impl::jump(ip_t dest, bool record_visits, bool track_knot_visit, boo
 	const container_t dest_id     = _story->find_container_for(dest_offset);
 
 	// If there's no destination container, stop.
-	if (dest_id == ~0U)
+	if (dest_id == ~0U) {
+		// Discard old stack, preserving save region.
+		_container.assign(nullptr, 0);
 		return;
+	}
 
 	// Are we entering the new container at its start?
 	using container_data_t                 = ink::internal::container_data_t;
@@ -366,15 +383,11 @@ void runner_impl::jump(ip_t dest, bool record_visits, bool track_knot_visit, boo
 	// If we're tracking knots, we only want the first one.
 	bool first_knot = track_knot_visit;
 
-	// Assemble temp stack in reverse order by traversing container tree.
-	container_t stack[abs(config::limitContainerDepth)];
-	uint32_t    depth = 0;
-	for (container_t id = dest_id; id != ~0U; /* advance in body */) {
-		// Append to stack.
-		inkAssert(depth < abs(config::limitContainerDepth), "Container depth limit exceeded in jump!");
-		stack[depth++] = id;
-
-		// Find container for this ID.
+	// The new container stack is the precomputed path from the root to the destination.
+	uint32_t           depth = 0;
+	const container_t* path  = _story->container_path(dest_id, depth);
+	for (uint32_t d = depth; d-- > 0;) {
+		const container_t       id        = path[d];
 		const container_data_t& container = _story->container_data(id);
 
 		// Is this a new knot?
@@ -399,15 +412,10 @@ void runner_impl::jump(ip_t dest, bool record_visits, bool track_knot_visit, boo
 				first_knot       = false;
 			}
 		}
-
-		// Next one.
-		id = container._parent;
 	}
 
-	// Reverse order onto final stack.
-	for (uint32_t d = 0; d < depth; ++d) {
-		_container.push(stack[depth - 1 - d]);
-	}
+	// Replace old stack, preserving save region.
+	_container.assign(path, depth);
 }
 
 template<frame_type type>
@@ -493,6 +501,8 @@ runner_impl::runner_impl(const story_impl* data, globals global)
 	_rng.srand(static_cast<uint32_t>(time(NULL)));
 #endif
 
+	_functions.set_call_sites(_story->call_site_names(), _story->num_call_sites());
+
 	// register with globals
 	_globals->add_runner(this);
 	if (_globals->lists()) {
@@ -532,12 +542,7 @@ runner_impl::line_type runner_impl::getline()
 #		error unsupported constraints for getline
 #	endif
 
-	// Fall through the fallback choice, if available
-	if (! has_choices() && _fallback_choice) {
-		choose(~0U);
-	}
-	inkAssert(_output.is_empty(), "Output should be empty after getline!");
-
+	finish_line();
 	return result;
 }
 
@@ -576,6 +581,12 @@ void runner_impl::getall(std::ostream& out)
 
 void runner_impl::advance_line()
 {
+	// the last line is still in the output
+	if (_line_pending) {
+		_line_pending = false;
+		return;
+	}
+
 	clear_tags(tags_clear_level::KEEP_KNOT);
 
 	// Step while we still have instructions to execute
@@ -796,11 +807,39 @@ const char* runner_impl::getline_alloc()
 {
 	advance_line();
 	const char* res = _output.get_alloc(_globals->strings(), _globals->lists());
+	finish_line();
+	return res;
+}
+
+bool runner_impl::getline(char* buffer, size_t capacity, size_t* needed)
+{
+	advance_line();
+	size_t size = _output.get(buffer, capacity);
+	if (needed) {
+		*needed = size;
+	}
+	if (size > capacity) {
+		_line_pending = true;
+		return false;
+	}
+	finish_line();
+	return true;
+}
+
+void runner_impl::getline(line_callback callback, void* context)
+{
+	advance_line();
+	_output.get(callback, context);
+	finish_line();
+}
+
+void runner_impl::finish_line()
+{
+	// Fall through the fallback choice, if available
 	if (! has_choices() && _fallback_choice) {
 		choose(~0U);
 	}
 	inkAssert(_output.is_empty(), "Output should be empty after getline!");
-	return res;
 }
 
 bool runner_impl::move_to(hash_t path)
@@ -843,7 +882,8 @@ bool runner_impl::migrate_to(const loader& loader, hash_t path)
 						    read<Command>(eval_start) == Command::END_EVAL,
 						    "expected an evaluation segment before defininng a temporary variable"
 						);
-						while (read<Command>(eval_start) != Command::START_EVAL) {
+						while (read<Command>(eval_start) != Command::START_EVAL
+						       && read<Command>(eval_start) != Command::EVAL_PUSH) {
 							eval_start -= 6;
 						}
 						jump(eval_start, false, false);
@@ -994,673 +1034,966 @@ bool runner_impl::line_step()
 	return false;
 }
 
-void runner_impl::step()
+// Commands without a dedicated handler: operators are forwarded to the executer
+template<Command C>
+void runner_impl::execute(const instruction&)
 {
-#ifdef INK_ENABLE_EXCEPTIONS
-	try {
-#endif
-		inkAssert(_ptr != nullptr, "Can not step! Do not have a valid pointer");
-
-		// Load current command
-		Command     cmd  = read<Command>();
-		CommandFlag flag = read<CommandFlag>();
+	if constexpr (C >= Command::OP_BEGIN && C < Command::OP_END) {
+		_operations(C, _eval);
+	} else {
+		inkFail("Unrecognized command!");
+	}
+}
 
-#ifdef INK_ENABLE_STL
-		if (_debug_stream != nullptr) {
-			*_debug_stream << "cmd " << cmd << " flags " << flag << " ";
+ip_t runner_impl::next_concat_add() const
+{
+	bool   in_string = false;
+	size_t pushes    = 0;
+	for (ip_t ptr = _ptr; ptr < _story->end(); ptr += CommandSize<uint32_t>) {
+		switch (_story->instruction_at(ptr).cmd) {
+			case Command::ADD: return ! in_string && pushes == 1 ? ptr : nullptr;
+			case Command::STR: pushes += in_string ? 0 : 1; break;
+			case Command::INT:
+			case Command::FLOAT:
+			case Command::BOOL:
+			case Command::PUSH_VARIABLE_VALUE:
+				if (in_string) {
+					return nullptr;
+				}
+				++pushes;
+				break;
+			case Command::START_STR:
+				if (in_string) {
+					return nullptr;
+				}
+				in_string = true;
+				break;
+			case Command::END_STR:
+				if (! in_string) {
+					return nullptr;
+				}
+				in_string = false;
+				++pushes;
+				break;
+			default: return nullptr;
 		}
-#endif
+		if (pushes > 1) {
+			return nullptr;
+		}
+	}
+	return nullptr;
+}
 
-		// If we're falling and we hit a non-fallthrough command, stop the fall.
-		if (_is_falling
-		    && ! (
-		        (cmd == Command::DIVERT && flag & CommandFlag::DIVERT_IS_FALLTHROUGH)
-		        || cmd == Command::END_CONTAINER_MARKER
-		    )) {
-			_is_falling = false;
-			set_done_ptr(nullptr);
+bool runner_impl::concat_chain()
+{
+	static constexpr size_t max_operands = 16;
+
+	value operands[max_operands];
+	operands[1] = _eval.pop();
+	operands[0] = _eval.pop();
+	if (! concatenates(operands[0].type()) || ! concatenates(operands[1].type())
+	    || (operands[0].type() != value_type::string && operands[1].type() != value_type::string)) {
+		_eval.push(operands[0]);
+		_eval.push(operands[1]);
+		return false;
+	}
+
+	// While the next instructions only push the right operand of another addition, run them and
+	// collect the operand instead of building each intermediate string.
+	size_t count = 2;
+	ip_t   add   = nullptr;
+	while (count < max_operands && (add = next_concat_add()) != nullptr) {
+		while (_ptr != add) {
+			step();
 		}
-		if (cmd >= Command::OP_BEGIN && cmd < Command::OP_END) {
-			read<uint32_t>();
-			_operations(cmd, _eval);
-		} else {
-			switch (cmd) {
-					// == Value Commands ==
-				case Command::STR: {
-					const char* str = read<const char*>();
+		value next = _eval.pop();
+		if (! concatenates(next.type())) {
+			// leave this addition to the executer
+			_eval.push(value{}.set<value_type::string>(
+			    concat_strings(_globals->strings(), operands, count)
+			));
+			_eval.push(next);
+			return true;
+		}
+		operands[count++] = next;
+		_ptr              = add + CommandSize<uint32_t>;
+	}
+
+	const char* str = concat_strings(_globals->strings(), operands, count);
+	_eval.push(value{}.set<value_type::string>(str));
+	return true;
+}
+
+template<>
+void runner_impl::execute<Command::ADD>(const instruction&)
+{
+	if (! concat_chain()) {
+		_operations(Command::ADD, _eval);
+	}
+}
+
+// == Value Commands ==
+template<>
+void runner_impl::execute<Command::STR>(const instruction& inst)
+{
+	const char* str = inst.arg.str;
 
 #ifdef INK_ENABLE_STL
-					if (_debug_stream != nullptr) {
-						*_debug_stream << "str \"" << str << "\"";
-					}
+	if (_debug_stream != nullptr) {
+		*_debug_stream << "str \"" << str << "\"";
+	}
 #endif
 
-					if (_evaluation_mode) {
-						_eval.push(value{}.set<value_type::string>(str));
-					} else {
-						_output << value{}.set<value_type::string>(str);
-					}
-				} break;
-				case Command::INT: {
-					int val = read<int>();
+	if (_evaluation_mode) {
+		_eval.push(value{}.set<value_type::string>(str));
+	} else {
+		// text of the story is not part of the string table, which allows the output to hand it out
+		// without a copy
+		_output << value{}.set<value_type::string>(str, false);
+	}
+}
+
+template<>
+void runner_impl::execute<Command::INT>(const instruction& inst)
+{
+	int val = inst.arg.sint;
 
 #ifdef INK_ENABLE_STL
-					if (_debug_stream != nullptr) {
-						*_debug_stream << "int " << val;
-					}
+	if (_debug_stream != nullptr) {
+		*_debug_stream << "int " << val;
+	}
 #endif
 
-					if (_evaluation_mode) {
-						_eval.push(value{}.set<value_type::int32>(static_cast<int32_t>(val)));
-					}
-					// TEST-CASE B006 don't print integers
-				} break;
-				case Command::BOOL: {
-					bool val = read<int>() ? true : false;
+	if (_evaluation_mode) {
+		_eval.push(value{}.set<value_type::int32>(static_cast<int32_t>(val)));
+	}
+	// TEST-CASE B006 don't print integers
+}
+
+template<>
+void runner_impl::execute<Command::BOOL>(const instruction& inst)
+{
+	bool val = inst.arg.sint ? true : false;
 
 #ifdef INK_ENABLE_STL
-					if (_debug_stream != nullptr) {
-						*_debug_stream << "bool " << (val ? "true" : "false");
-					}
+	if (_debug_stream != nullptr) {
+		*_debug_stream << "bool " << (val ? "true" : "false");
+	}
 #endif
 
-					if (_evaluation_mode) {
-						_eval.push(value{}.set<value_type::boolean>(val));
-					} else {
-						_output << value{}.set<value_type::boolean>(val);
-					}
-				} break;
-				case Command::FLOAT: {
-					float val = read<float>();
+	if (_evaluation_mode) {
+		_eval.push(value{}.set<value_type::boolean>(val));
+	} else {
+		_output << value{}.set<value_type::boolean>(val);
+	}
+}
+
+template<>
+void runner_impl::execute<Command::FLOAT>(const instruction& inst)
+{
+	float val = inst.arg.real;
 
 #ifdef INK_ENABLE_STL
-					if (_debug_stream != nullptr) {
-						*_debug_stream << "float " << val;
-					}
+	if (_debug_stream != nullptr) {
+		*_debug_stream << "float " << val;
+	}
 #endif
 
-					if (_evaluation_mode) {
-						_eval.push(value{}.set<value_type::float32>(val));
-					}
-					// TEST-CASE B006 don't print floats
-				} break;
-				case Command::VALUE_POINTER: {
-					hash_t val = read<hash_t>();
+	if (_evaluation_mode) {
+		_eval.push(value{}.set<value_type::float32>(val));
+	}
+	// TEST-CASE B006 don't print floats
+}
+
+template<>
+void runner_impl::execute<Command::VALUE_POINTER>(const instruction& inst)
+{
+	hash_t val = inst.arg.uint;
 
 #ifdef INK_ENABLE_STL
-					if (_debug_stream != nullptr) {
-						*_debug_stream << "value_pointer ";
-						write_hash(*_debug_stream, val);
-					}
+	if (_debug_stream != nullptr) {
+		*_debug_stream << "value_pointer ";
+		write_hash(*_debug_stream, val);
+	}
 #endif
 
-					if (_evaluation_mode) {
-						_eval.push(value{}.set<value_type::value_pointer>(val, static_cast<char>(flag) - 1));
-					} else {
-						inkFail("never conciderd what should happend here! (value pointer print)");
-					}
-				} break;
-				case Command::LIST: {
-					list_table::list list(read<int>());
+	if (_evaluation_mode) {
+		_eval.push(value{}.set<value_type::value_pointer>(val, static_cast<char>(inst.flag) - 1));
+	} else {
+		inkFail("never conciderd what should happend here! (value pointer print)");
+	}
+}
+
+template<>
+void runner_impl::execute<Command::LIST>(const instruction& inst)
+{
+	list_table::list list(inst.arg.sint);
 
 #ifdef INK_ENABLE_STL
-					if (_debug_stream != nullptr) {
-						*_debug_stream << "list " << list.lid;
-					}
+	if (_debug_stream != nullptr) {
+		*_debug_stream << "list " << list.lid;
+	}
 #endif
 
-					if (_evaluation_mode) {
-						_eval.push(value{}.set<value_type::list>(list));
-					} else {
-						char* str = _globals->strings().create(_globals->lists().stringLen(list) + 1);
-						_globals->lists().toString(str, list)[0] = 0;
-						_output << value{}.set<value_type::string>(str);
-					}
-				} break;
-				case Command::DIVERT_VAL: {
-					inkAssert(_evaluation_mode, "Can not push divert value into the output stream!");
-
-					// Push the divert target onto the stack
-					uint32_t target = read<uint32_t>();
-					_eval.push(value{}.set<value_type::divert>(target));
-				} break;
-				case Command::NEWLINE: {
-					read<uint32_t>();
-					if (_evaluation_mode) {
-						_eval.push(values::newline);
-					} else {
-						if (! _output.ends_with(value_type::newline)) {
-							_output << values::newline;
-						}
-					}
-				} break;
-				case Command::GLUE: {
-					read<uint32_t>();
-					if (_evaluation_mode) {
-						_eval.push(values::glue);
-					} else {
-						_output << values::glue;
-					}
-				} break;
-				case Command::VOID: {
-					read<uint32_t>();
-					if (_evaluation_mode) {
-						_eval.push(values::null); // TODO: void type?
-					}
-				} break;
+	if (_evaluation_mode) {
+		_eval.push(value{}.set<value_type::list>(list));
+	} else {
+		char* str = _globals->strings().create(_globals->lists().stringLen(list) + 1);
+		_globals->lists().toString(str, list)[0] = 0;
+		_output << value{}.set<value_type::string>(str);
+	}
+}
+
+template<>
+void runner_impl::execute<Command::DIVERT_VAL>(const instruction& inst)
+{
+	inkAssert(_evaluation_mode, "Can not push divert value into the output stream!");
 
-				// == Divert commands
-				case Command::DIVERT: {
-					// Find divert address
-					uint32_t target = read<uint32_t>();
+	// Push the divert target onto the stack
+	uint32_t target = inst.arg.uint;
+	_eval.push(value{}.set<value_type::divert>(target));
+}
+
+template<>
+void runner_impl::execute<Command::NEWLINE>(const instruction&)
+{
+	if (_evaluation_mode) {
+		_eval.push(values::newline);
+	} else {
+		if (! _output.ends_with(value_type::newline)) {
+			_output << values::newline;
+		}
+	}
+}
+
+template<>
+void runner_impl::execute<Command::GLUE>(const instruction&)
+{
+	if (_evaluation_mode) {
+		_eval.push(values::glue);
+	} else {
+		_output << values::glue;
+	}
+}
+
+template<>
+void runner_impl::execute<Command::VOID>(const instruction&)
+{
+	if (_evaluation_mode) {
+		_eval.push(values::null); // TODO: void type?
+	}
+}
+
+template<>
+void runner_impl::execute<Command::TAG>(const instruction&)
+{
+	inkFail("Command::TAG is Deprecated!");
+}
+
+// == Divert commands
+template<>
+void runner_impl::execute<Command::DIVERT>(const instruction& inst)
+{
+	const CommandFlag flag = inst.flag;
+
+	// Find divert address
+	uint32_t target = inst.arg.uint;
 
 #ifdef INK_ENABLE_STL
-					if (_debug_stream != nullptr) {
-						*_debug_stream << "target " << target;
-					}
+	if (_debug_stream != nullptr) {
+		*_debug_stream << "target " << target;
+	}
 #endif
 
-					// Check for condition
-					if (flag & CommandFlag::DIVERT_HAS_CONDITION && ! _eval.pop().truthy(_globals->lists())) {
-						break;
-					}
+	// Check for condition
+	if (flag & CommandFlag::DIVERT_HAS_CONDITION && ! _eval.pop().truthy(_globals->lists())) {
+		return;
+	}
 
-					// SPECIAL: Fallthrough divert. We're starting to fall out of containers
-					if (flag & CommandFlag::DIVERT_IS_FALLTHROUGH && ! _is_falling) {
-						// Record the position of the instruction pointer at the first fallthrough.
-						//  We'll use this if we run out of content and hit an implied "done" to restore
-						//  our position when a choice is chosen. See ::choose
-						// Only update if not already set: after choices are presented, subsequent
-						// fallthrough diverts at the root level (between named knots) must not
-						// overwrite the valid done pointer we already recorded.
-						if (_done == nullptr) {
-							set_done_ptr(_ptr);
-						}
-						_is_falling = true;
-					}
+	// SPECIAL: Fallthrough divert. We're starting to fall out of containers
+	if (flag & CommandFlag::DIVERT_IS_FALLTHROUGH && ! _is_falling) {
+		// Record the position of the instruction pointer at the first fallthrough.
+		//  We'll use this if we run out of content and hit an implied "done" to restore
+		//  our position when a choice is chosen. See ::choose
+		// Only update if not already set: after choices are presented, subsequent
+		// fallthrough diverts at the root level (between named knots) must not
+		// overwrite the valid done pointer we already recorded.
+		if (_done == nullptr) {
+			set_done_ptr(_ptr);
+		}
+		_is_falling = true;
+	}
+
+	// If we're falling out of the story, then we're hitting an implied done
+	if (_is_falling && _story->instructions() + target == _story->end()) {
+		// Wait! We may be returning from a function!
+		frame_type type;
+		if (_stack.has_frame(&type) && type == frame_type::function) // implicit return is only for
+		                                                             // functions
+		{
+			// push null and return
+			_eval.push(values::null);
+
+			// HACK
+			_ptr += sizeof(Command) + sizeof(CommandFlag);
+			execute_return();
+		} else {
+			on_done(false);
+		}
+		return;
+	}
 
-					// If we're falling out of the story, then we're hitting an implied done
-					if (_is_falling && _story->instructions() + target == _story->end()) {
-						// Wait! We may be returning from a function!
-						frame_type type;
-						if (_stack.has_frame(&type)
-						    && type == frame_type::function) // implicit return is only for functions
-						{
-							// push null and return
-							_eval.push(values::null);
-
-							// HACK
-							_ptr += sizeof(Command) + sizeof(CommandFlag);
-							execute_return();
-						} else {
-							on_done(false);
-						}
-						break;
-					}
+	// Do the jump
+	inkAssert(_story->instructions() + target < _story->end(), "Diverting past end of story data!");
+	jump(_story->instructions() + target, true, ! (flag & CommandFlag::DIVERT_HAS_CONDITION));
+}
+
+template<>
+void runner_impl::execute<Command::DIVERT_TO_VARIABLE>(const instruction& inst)
+{
+	const CommandFlag flag = inst.flag;
 
-					// Do the jump
-					inkAssert(
-					    _story->instructions() + target < _story->end(), "Diverting past end of story data!"
-					);
-					jump(_story->instructions() + target, true, ! (flag & CommandFlag::DIVERT_HAS_CONDITION));
-				} break;
-				case Command::DIVERT_TO_VARIABLE: {
-					// Get variable value
-					hash_t variable = read<hash_t>();
+	// Get variable value
+	hash_t variable = inst.arg.uint;
 
 #ifdef INK_ENABLE_STL
-					if (_debug_stream != nullptr) {
-						*_debug_stream << "variable ";
-						write_hash(*_debug_stream, variable);
-					}
+	if (_debug_stream != nullptr) {
+		*_debug_stream << "variable ";
+		write_hash(*_debug_stream, variable);
+	}
 #endif
 
-					// Check for condition
-					if (flag & CommandFlag::DIVERT_HAS_CONDITION && ! _eval.pop().truthy(_globals->lists())) {
-						break;
-					}
+	// Check for condition
+	if (flag & CommandFlag::DIVERT_HAS_CONDITION && ! _eval.pop().truthy(_globals->lists())) {
+		return;
+	}
 
-					const value* val = get_var(variable);
-					inkAssert(val, "Jump destiniation needs to be defined!");
-
-					// Move to location
-					jump(
-					    _story->instructions() + val->get<value_type::divert>(), true,
-					    ! (flag & CommandFlag::DIVERT_HAS_CONDITION)
-					);
-					inkAssert(_ptr < _story->end(), "Diverted past end of story data!");
-				} break;
-
-				// == Terminal commands
-				case Command::DONE:
-					read<uint32_t>();
-					on_done(true);
-					break;
+	const value* val = get_var(variable, inst.slot);
+	inkAssert(val, "Jump destiniation needs to be defined!");
 
-				case Command::END:
-					read<uint32_t>();
-					_ptr = nullptr;
-					break;
+	// Move to location
+	jump(
+	    _story->instructions() + val->get<value_type::divert>(), true,
+	    ! (flag & CommandFlag::DIVERT_HAS_CONDITION)
+	);
+	inkAssert(_ptr < _story->end(), "Diverted past end of story data!");
+}
 
-				// == Tunneling
-				case Command::TUNNEL: {
-					uint32_t target;
-					// Find divert address
-					if (flag & CommandFlag::TUNNEL_TO_VARIABLE) {
-						hash_t       var_name = read<hash_t>();
-						const value* val      = get_var(var_name);
-						inkAssert(val != nullptr, "Variable containing tunnel target could not be found!");
-						target = val->get<value_type::divert>();
-					} else {
-						target = read<uint32_t>();
-					}
+// == Terminal commands
+template<>
+void runner_impl::execute<Command::DONE>(const instruction&)
+{
+	on_done(true);
+}
+
+template<>
+void runner_impl::execute<Command::END>(const instruction&)
+{
+	_ptr = nullptr;
+}
+
+// == Tunneling
+template<>
+void runner_impl::execute<Command::TUNNEL>(const instruction& inst)
+{
+	uint32_t target;
+	// Find divert address
+	if (inst.flag & CommandFlag::TUNNEL_TO_VARIABLE) {
+		hash_t       var_name = inst.arg.uint;
+		const value* val      = get_var(var_name, inst.slot);
+		inkAssert(val != nullptr, "Variable containing tunnel target could not be found!");
+		target = val->get<value_type::divert>();
+	} else {
+		target = inst.arg.uint;
+	}
 
 #ifdef INK_ENABLE_STL
-					if (_debug_stream != nullptr) {
-						*_debug_stream << "target " << target;
-					}
+	if (_debug_stream != nullptr) {
+		*_debug_stream << "target " << target;
+	}
 #endif
 
-					start_frame<frame_type::tunnel>(target);
-				} break;
-				case Command::FUNCTION: {
-					uint32_t target;
-					// Find divert address
-					if (flag & CommandFlag::FUNCTION_TO_VARIABLE) {
-						hash_t       var_name = read<hash_t>();
-						const value* val      = get_var(var_name);
-						inkAssert(val != nullptr, "Varibale containing function could not be found!");
-						target = val->get<value_type::divert>();
-					} else {
-						target = read<uint32_t>();
-					}
+	start_frame<frame_type::tunnel>(target);
+}
+
+template<>
+void runner_impl::execute<Command::FUNCTION>(const instruction& inst)
+{
+	uint32_t target;
+	// Find divert address
+	if (inst.flag & CommandFlag::FUNCTION_TO_VARIABLE) {
+		hash_t       var_name = inst.arg.uint;
+		const value* val      = get_var(var_name, inst.slot);
+		inkAssert(val != nullptr, "Varibale containing function could not be found!");
+		target = val->get<value_type::divert>();
+	} else {
+		target = inst.arg.uint;
+	}
 
 #ifdef INK_ENABLE_STL
-					if (_debug_stream != nullptr) {
-						*_debug_stream << "target " << target;
-					}
+	if (_debug_stream != nullptr) {
+		*_debug_stream << "target " << target;
+	}
 #endif
 
-					if (! (flag & CommandFlag::FALLBACK_FUNCTION)) {
-						start_frame<frame_type::function>(target);
-					} else {
-						inkAssert(! _eval.is_empty(), "fallback function but no function call before?");
-						if (_eval.top_value().type() == value_type::ex_fn_not_found) {
-							_eval.pop();
-							inkAssert(
-							    target != 0,
-							    "Exetrnal function was not binded, and no fallback function provided!"
-							);
-							start_frame<frame_type::function>(target);
-						}
-					}
-				} break;
-				case Command::TUNNEL_RETURN:
-				case Command::FUNCTION_RETURN: {
-					read<uint32_t>();
-					execute_return();
-				} break;
-
-				case Command::THREAD: {
-					read<uint32_t>();
-					// Push a thread frame so we can return easily
-					// TODO We push ahead of a single divert. Is that correct in all cases....?????
-					auto returnTo = _ptr + CommandSize<uint32_t>;
-					_stack.push_frame<frame_type::thread>(
-					    static_cast<offset_t>(returnTo - _story->instructions()), _evaluation_mode
-					);
-					_ref_stack.push_frame<frame_type::thread>(
-					    static_cast<offset_t>(returnTo - _story->instructions()), _evaluation_mode
-					);
-
-					// Fork a new thread on the callstack
-					thread_t thread = _stack.fork_thread();
-					{
-						thread_t t = _ref_stack.fork_thread();
-						inkAssert(t == thread, "ref_stack and stack should be in sync!");
-					}
+	if (! (inst.flag & CommandFlag::FALLBACK_FUNCTION)) {
+		start_frame<frame_type::function>(target);
+	} else {
+		inkAssert(! _eval.is_empty(), "fallback function but no function call before?");
+		if (_eval.top_value().type() == value_type::ex_fn_not_found) {
+			_eval.pop();
+			inkAssert(target != 0, "Exetrnal function was not binded, and no fallback function provided!");
+			start_frame<frame_type::function>(target);
+		}
+	}
+}
+
+template<>
+void runner_impl::execute<Command::TUNNEL_RETURN>(const instruction&)
+{
+	execute_return();
+}
+
+template<>
+void runner_impl::execute<Command::FUNCTION_RETURN>(const instruction&)
+{
+	execute_return();
+}
+
+template<>
+void runner_impl::execute<Command::THREAD>(const instruction&)
+{
+	// Push a thread frame so we can return easily
+	// TODO We push ahead of a single divert. Is that correct in all cases....?????
+	auto returnTo = _ptr + CommandSize<uint32_t>;
+	_stack.push_frame<frame_type::thread>(
+	    static_cast<offset_t>(returnTo - _story->instructions()), _evaluation_mode
+	);
+	_ref_stack.push_frame<frame_type::thread>(
+	    static_cast<offset_t>(returnTo - _story->instructions()), _evaluation_mode
+	);
+
+	// Fork a new thread on the callstack
+	thread_t thread = _stack.fork_thread();
+	{
+		thread_t t = _ref_stack.fork_thread();
+		inkAssert(t == thread, "ref_stack and stack should be in sync!");
+	}
 
 #ifdef INK_ENABLE_STL
-					if (_debug_stream != nullptr) {
-						*_debug_stream << "thread " << thread;
-					}
+	if (_debug_stream != nullptr) {
+		*_debug_stream << "thread " << thread;
+	}
 #endif
 
-					// Push that thread onto our thread stack
-					_threads.push(thread);
-				} break;
+	// Push that thread onto our thread stack
+	_threads.push(thread);
+}
 
-				// == set temporärie variable
-				case Command::DEFINE_TEMP: {
-					hash_t variableName = read<hash_t>();
-					bool   is_redef     = flag & CommandFlag::ASSIGNMENT_IS_REDEFINE;
+// == set temporärie variable
+template<>
+void runner_impl::execute<Command::DEFINE_TEMP>(const instruction& inst)
+{
+	hash_t variableName = inst.arg.uint;
+	bool   is_redef     = inst.flag & CommandFlag::ASSIGNMENT_IS_REDEFINE;
 
 #ifdef INK_ENABLE_STL
-					if (_debug_stream != nullptr) {
-						*_debug_stream << "variable_name ";
-						write_hash(*_debug_stream, variableName);
-						*_debug_stream << " is_redef " << (is_redef ? "yes" : "no");
-					}
+	if (_debug_stream != nullptr) {
+		*_debug_stream << "variable_name ";
+		write_hash(*_debug_stream, variableName);
+		*_debug_stream << " is_redef " << (is_redef ? "yes" : "no");
+	}
 #endif
 
-					// Get the top value and put it into the variable
-					value v = _eval.pop();
-					set_var<Scope::LOCAL>(variableName, v, is_redef);
-				} break;
+	// Get the top value and put it into the variable
+	value v = _eval.pop();
+	set_var<Scope::LOCAL>(variableName, v, is_redef);
+}
+
+template<>
+void runner_impl::execute<Command::SET_VARIABLE>(const instruction& inst)
+{
+	hash_t variableName = inst.arg.uint;
 
-				case Command::SET_VARIABLE: {
-					hash_t variableName = read<hash_t>();
+	// Check if it's a redefinition (not yet used, seems important for pointers later?)
+	bool is_redef = inst.flag & CommandFlag::ASSIGNMENT_IS_REDEFINE;
 
-					// Check if it's a redefinition (not yet used, seems important for pointers later?)
-					bool is_redef = flag & CommandFlag::ASSIGNMENT_IS_REDEFINE;
+	// If not, we're setting a global (temporary variables are explicitely defined as such,
+	//  where globals are defined using SET_VARIABLE).
+	value val = _eval.pop();
 
-					// If not, we're setting a global (temporary variables are explicitely defined as such,
-					//  where globals are defined using SET_VARIABLE).
-					value val = _eval.pop();
+#ifdef INK_ENABLE_STL
+	if (_debug_stream != nullptr) {
+		*_debug_stream << "variable_name ";
+		write_hash(*_debug_stream, variableName);
+		*_debug_stream << " is_redef " << (is_redef ? "yes" : "no");
+	}
+#endif
+
+	if (inst.slot != InvalidSlot) {
+		set_global(inst.slot, val, is_redef);
+	} else if (is_redef) {
+		set_var(variableName, val, is_redef);
+	} else {
+		set_var<Scope::GLOBAL>(variableName, val, is_redef);
+	}
+}
+
+// == Function calls
+template<>
+void runner_impl::execute<Command::CALL_EXTERNAL>(const instruction& inst)
+{
+	// Interpret flag as argument count
+	int numArguments = static_cast<int>(inst.flag);
 
 #ifdef INK_ENABLE_STL
-					if (_debug_stream != nullptr) {
-						*_debug_stream << "variable_name ";
-						write_hash(*_debug_stream, variableName);
-						*_debug_stream << " is_redef " << (is_redef ? "yes" : "no");
-					}
+	if (_debug_stream != nullptr) {
+		*_debug_stream << "function_name ";
+		write_hash(*_debug_stream, inst.arg.uint);
+		*_debug_stream << " numArguments " << numArguments;
+	}
 #endif
 
-					if (is_redef) {
-						set_var(variableName, val, is_redef);
-					} else {
-						set_var<Scope::GLOBAL>(variableName, val, is_redef);
-					}
-				} break;
+	// find and execute. will automatically push a valid if applicable
+	// the function was resolved for this call site when it was bound
+	auto* fn = _functions.at_call_site(inst.call_site);
+	if (fn == nullptr) {
+		_eval.push(values::ex_fn_not_found);
+	} else if (_output.saved() && _output.ends_with(value_type::newline, _output.save_offset())
+	           && ! fn->lookaheadSafe()) {
+		// TODO: seperate token?
+		_output.append(values::null);
+	} else {
+		fn->call(&_eval, numArguments, _globals->strings(), _globals->lists());
+	}
+}
 
-				// == Function calls
-				case Command::CALL_EXTERNAL: {
-					// Read function name
-					hash_t functionName = read<hash_t>();
+// == Evaluation stack
+template<>
+void runner_impl::execute<Command::START_EVAL>(const instruction&)
+{
+	_evaluation_mode = true;
+}
 
-					// Interpret flag as argument count
-					int numArguments = static_cast<int>(flag);
+template<>
+void runner_impl::execute<Command::END_EVAL>(const instruction&)
+{
+	_evaluation_mode = false;
+
+	// Assert stack is empty? Is that necessary?
+}
+
+template<>
+void runner_impl::execute<Command::OUTPUT>(const instruction&)
+{
+	value v = _eval.pop();
+	_output << v;
+}
+
+template<>
+void runner_impl::execute<Command::POP>(const instruction&)
+{
+	_eval.pop();
+}
+
+template<>
+void runner_impl::execute<Command::DUPLICATE>(const instruction&)
+{
+	_eval.push(_eval.top_value());
+}
+
+template<>
+void runner_impl::execute<Command::PUSH_VARIABLE_VALUE>(const instruction& inst)
+{
+	// Try to find in local stack
+	hash_t       variableName = inst.arg.uint;
+	const value* val          = get_var(variableName, inst.slot);
 
 #ifdef INK_ENABLE_STL
-					if (_debug_stream != nullptr) {
-						*_debug_stream << "function_name ";
-						write_hash(*_debug_stream, functionName);
-						*_debug_stream << " numArguments " << numArguments;
-					}
+	if (_debug_stream != nullptr) {
+		*_debug_stream << "variable_name ";
+		write_hash(*_debug_stream, variableName);
+		*_debug_stream << " val \"" << val << "\"";
+	}
 #endif
 
-					// find and execute. will automatically push a valid if applicable
-					auto* fn = _functions.find(functionName);
-					if (fn == nullptr) {
-						_eval.push(values::ex_fn_not_found);
-					} else if (_output.saved()
-					           && _output.ends_with(value_type::newline, _output.save_offset())
-					           && ! fn->lookaheadSafe()) {
-						// TODO: seperate token?
-						_output.append(values::null);
-					} else {
-						fn->call(&_eval, numArguments, _globals->strings(), _globals->lists());
-					}
-				} break;
+	inkAssert(val != nullptr, "Could not find variable!");
+	_eval.push(*val);
+}
 
-				// == Evaluation stack
-				case Command::START_EVAL:
-					read<uint32_t>();
-					_evaluation_mode = true;
-					break;
-				case Command::END_EVAL:
-					read<uint32_t>();
-					_evaluation_mode = false;
+template<>
+void runner_impl::execute<Command::START_STR>(const instruction&)
+{
+	inkAssert(_evaluation_mode, "Can not enter string mode while not in evaluation mode!");
+	_string_mode     = true;
+	_evaluation_mode = false;
+	_output << values::marker;
+}
 
-					// Assert stack is empty? Is that necessary?
-					break;
-				case Command::OUTPUT: {
-					read<uint32_t>();
-					value v = _eval.pop();
-					_output << v;
-				} break;
-				case Command::POP:
-					read<uint32_t>();
-					_eval.pop();
-					break;
-				case Command::DUPLICATE:
-					read<uint32_t>();
-					_eval.push(_eval.top_value());
-					break;
-				case Command::PUSH_VARIABLE_VALUE: {
-					// Try to find in local stack
-					hash_t       variableName = read<hash_t>();
-					const value* val          = get_var(variableName);
+template<>
+void runner_impl::execute<Command::END_STR>(const instruction&)
+{
+	// TODO: Assert we really had a marker on there?
+	inkAssert(! _evaluation_mode, "Must be in evaluation mode");
+	_string_mode     = false;
+	_evaluation_mode = true;
+
+	// Load value from output stream
+	// Push onto stack
+	_eval.push(value{}.set<value_type::string>(
+	    _output.get_alloc<false>(_globals->strings(), _globals->lists())
+	));
+}
+
+// == Tag commands
+template<>
+void runner_impl::execute<Command::START_TAG>(const instruction&)
+{
+	_output << values::marker;
+}
+
+template<>
+void runner_impl::execute<Command::END_TAG>(const instruction&)
+{
+	auto tag = _output.get_alloc<true>(_globals->strings(), _globals->lists());
+	add_tag(tag, tags_level::UNKNOWN);
+}
+
+// == Choice commands
+template<>
+void runner_impl::execute<Command::CHOICE>(const instruction& inst)
+{
+	const CommandFlag flag = inst.flag;
+
+	// Read path
+	uint32_t path = inst.arg.uint;
 
 #ifdef INK_ENABLE_STL
-					if (_debug_stream != nullptr) {
-						*_debug_stream << "variable_name ";
-						write_hash(*_debug_stream, variableName);
-						*_debug_stream << " val \"" << val << "\"";
-					}
+	if (_debug_stream != nullptr) {
+		*_debug_stream << "path " << path;
+	}
 #endif
 
-					inkAssert(val != nullptr, "Could not find variable!");
-					_eval.push(*val);
-					break;
-				}
-				case Command::START_STR: {
-					read<uint32_t>();
-					inkAssert(_evaluation_mode, "Can not enter string mode while not in evaluation mode!");
-					_string_mode     = true;
-					_evaluation_mode = false;
-					_output << values::marker;
-				} break;
-				case Command::END_STR: {
-					read<uint32_t>();
-					// TODO: Assert we really had a marker on there?
-					inkAssert(! _evaluation_mode, "Must be in evaluation mode");
-					_string_mode     = false;
-					_evaluation_mode = true;
-
-					// Load value from output stream
-					// Push onto stack
-					_eval.push(value{}.set<value_type::string>(
-					    _output.get_alloc<false>(_globals->strings(), _globals->lists())
-					));
-				} break;
-
-				// == Tag commands
-				case Command::START_TAG: {
-					read<uint32_t>();
-					_output << values::marker;
-				} break;
-
-
-				case Command::END_TAG: {
-					read<uint32_t>();
-					auto tag = _output.get_alloc<true>(_globals->strings(), _globals->lists());
-					add_tag(tag, tags_level::UNKNOWN);
-				} break;
-
-				// == Choice commands
-				case Command::CHOICE: {
-					// Read path
-					uint32_t path = read<uint32_t>();
+	// If we're a once only choice, make sure our destination hasn't
+	//  been visited
+	if (flag & CommandFlag::CHOICE_IS_ONCE_ONLY) {
+		// Destination container index was resolved when loading the story
+		const container_t destination = inst.container;
+		inkAssert(destination != ~0U, "Destination for choice block does not have counting flags.");
+		// Ignore the choice if we've visited the destination before
+		if (_globals->visits(destination) > 0) {
+			return;
+		}
+	}
+
+	// Choice is conditional
+	if (flag & CommandFlag::CHOICE_HAS_CONDITION) {
+		// Only show if the top of the eval stack is 'truthy'
+		if (! _eval.pop().truthy(_globals->lists())) {
+			return;
+		}
+	}
+
+	// Use a marker to start compiling the choice text
+	_output << values::marker;
+	value stack[2];
+	int   sc = 0;
+
+	if (flag & CommandFlag::CHOICE_HAS_START_CONTENT) {
+		stack[sc++] = _eval.pop();
+	}
+	if (flag & CommandFlag::CHOICE_HAS_CHOICE_ONLY_CONTENT) {
+		stack[sc++] = _eval.pop();
+	}
+	for (; sc; --sc) {
+		_output << stack[sc - 1];
+	}
+
+	// Fetch tags related to the current choice
+
+	size_t start = _tags_begin[static_cast<int>(tags_level::CHOICE) + 1];
+	assign_tags({tags_level::CHOICE});
+	const snap_tag* tags_start = _tags.data() + start;
+	const snap_tag* tags_end   = _tags.data() + _tags_begin[static_cast<int>(tags_level::CHOICE) + 1];
+
+	// Create choice and record it
+	choice* current_choice = nullptr;
+	if (flag & CommandFlag::CHOICE_IS_INVISIBLE_DEFAULT) {
+		_fallback_choice.emplace();
+		current_choice = &_fallback_choice.value();
+	} else {
+		current_choice = &add_choice();
+	}
+	current_choice->setup(
+	    _output, _globals->strings(), _globals->lists(), _choices.size() - 1, path, current_thread(),
+	    tags_start, tags_end
+	);
+	// save stack at last choice
+	if (_saved) {
+		forget();
+	}
+	save();
+}
+
+template<>
+void runner_impl::execute<Command::START_CONTAINER_MARKER>(const instruction& inst)
+{
+	// Keep track of current container
+	auto index = inst.arg.uint;
+	// offset points to command, command has size 6
+	_container.push(index);
+
+	// Increment visit count
+	if (uint8_t(inst.flag)
+	    & (uint8_t(CommandFlag::CONTAINER_MARKER_TRACK_VISITS)
+	       | uint8_t(CommandFlag::CONTAINER_MARKER_TRACK_TURNS))) {
+		_globals->visit(index);
+	}
+	if (inst.flag & CommandFlag::CONTAINER_MARKER_IS_KNOT) {
+		_current_knot_id = index;
+		_entered_knot    = true;
+	}
+}
+
+template<>
+void runner_impl::execute<Command::END_CONTAINER_MARKER>(const instruction& inst)
+{
+	container_t index = inst.arg.uint;
+	inkAssert(_container.top() == index, "Leaving container we are not in!");
+
+	// Move up out of the current container
+	_container.pop();
+
+	// SPECIAL: If we've popped all containers, then there's an implied
+	// 'done' command or return
+	if (_container.empty()) {
+		_is_falling = false;
+
+		frame_type type;
+		if (! _threads.empty()) {
+			on_done(false);
+			return;
+		} else if (_stack.has_frame(&type) && type == frame_type::function) // implicit return
+		                                                                    // is only for
+		                                                                    // functions
+		{
+			// push null and return
+			_eval.push(values::null);
+
+			// HACK
+			_ptr += sizeof(Command) + sizeof(CommandFlag);
+			execute_return();
+		} else if (_ptr == _story->end()) { // check needed, because it colud exist an unnamed
+			                                  // toplevel container (empty named container stack
+			                                  // != empty container stack)
+			on_done(true);
+		}
+	}
+}
+
+template<>
+void runner_impl::execute<Command::VISIT>(const instruction&)
+{
+	// Push the visit count for the current container to the top
+	//  is 0-indexed for some reason. idk why but this is what ink expects
+	_eval.push(
+	    value{}.set<value_type::int32>(static_cast<int32_t>(_globals->visits(_container.top()) - 1))
+	);
+}
+
+template<>
+void runner_impl::execute<Command::TURN>(const instruction&)
+{
+	_eval.push(value{}.set<value_type::int32>(static_cast<int32_t>(_globals->turns())));
+}
+
+template<>
+void runner_impl::execute<Command::SEQUENCE>(const instruction&)
+{
+	// TODO: The C# ink runtime does a bunch of fancy logic
+	//  to make sure each element is picked at least once in every
+	//  iteration loop. I don't feel like replicating that right now.
+	// So, let's just return a random number and *shrug*
+	int sequenceLength = _eval.pop().get<value_type::int32>();
+	/* shuffel index */
+	_eval.pop();
+
+
+	_eval.push(value{}.set<value_type::int32>(static_cast<int32_t>(_rng.rand(sequenceLength))));
+}
+
+template<>
+void runner_impl::execute<Command::SEED>(const instruction&)
+{
+	int32_t seed = _eval.pop().get<value_type::int32>();
+	_rng.srand(seed);
 
 #ifdef INK_ENABLE_STL
-					if (_debug_stream != nullptr) {
-						*_debug_stream << "path " << path;
-					}
+	if (_debug_stream != nullptr) {
+		*_debug_stream << "seed " << seed;
+	}
 #endif
 
-					// If we're a once only choice, make sure our destination hasn't
-					//  been visited
-					if (flag & CommandFlag::CHOICE_IS_ONCE_ONLY) {
-						// Need to convert offset to container index
-						container_t destination = ~0U;
-						if (_story->find_container_id(path, destination)) {
-							// Ignore the choice if we've visited the destination before
-							if (_globals->visits(destination) > 0) {
-								break;
-							}
-						} else {
-							inkAssert(false, "Destination for choice block does not have counting flags.");
-						}
-					}
+	_eval.push(values::null);
+}
 
-					// Choice is conditional
-					if (flag & CommandFlag::CHOICE_HAS_CONDITION) {
-						// Only show if the top of the eval stack is 'truthy'
-						if (! _eval.pop().truthy(_globals->lists())) {
-							break;
-						}
-					}
+template<>
+void runner_impl::execute<Command::READ_COUNT>(const instruction& inst)
+{
+	// Get container index
+	container_t container = inst.arg.uint;
 
-					// Use a marker to start compiling the choice text
-					_output << values::marker;
-					value stack[2];
-					int   sc = 0;
+	// Push the read count for the requested container index
+	_eval.push(value{}.set<value_type::int32>(static_cast<int32_t>(_globals->visits(container))));
+}
 
-					if (flag & CommandFlag::CHOICE_HAS_START_CONTENT) {
-						stack[sc++] = _eval.pop();
-					}
-					if (flag & CommandFlag::CHOICE_HAS_CHOICE_ONLY_CONTENT) {
-						stack[sc++] = _eval.pop();
-					}
-					for (; sc; --sc) {
-						_output << stack[sc - 1];
-					}
+// == Superinstructions ==
+// The commands following a superinstruction are its operands, the handler consumes them.
+namespace
+{
+	bool compare(Command op, int32_t lhs, int32_t rhs)
+	{
+		switch (op) {
+			case Command::IS_EQUAL: return lhs == rhs;
+			case Command::NOT_EQUAL: return lhs != rhs;
+			case Command::GREATER_THAN: return lhs > rhs;
+			case Command::LESS_THAN: return lhs < rhs;
+			case Command::GREATER_THAN_EQUALS: return lhs >= rhs;
+			case Command::LESS_THAN_EQUALS: return lhs <= rhs;
+			default: inkFail("Superinstruction with unexpected comparison!"); return false;
+		}
+	}
+} // namespace
 
-					// Fetch tags related to the current choice
-
-					size_t start = _tags_begin[static_cast<int>(tags_level::CHOICE) + 1];
-					assign_tags({tags_level::CHOICE});
-					const snap_tag* tags_start = _tags.data() + start;
-					const snap_tag* tags_end
-					    = _tags.data() + _tags_begin[static_cast<int>(tags_level::CHOICE) + 1];
-
-					// Create choice and record it
-					choice* current_choice = nullptr;
-					if (flag & CommandFlag::CHOICE_IS_INVISIBLE_DEFAULT) {
-						_fallback_choice.emplace();
-						current_choice = &_fallback_choice.value();
-					} else {
-						current_choice = &add_choice();
-					}
-					current_choice->setup(
-					    _output, _globals->strings(), _globals->lists(), _choices.size() - 1, path,
-					    current_thread(), tags_start, tags_end
-					);
-					// save stack at last choice
-					if (_saved) {
-						forget();
-					}
-					save();
-				} break;
-				case Command::START_CONTAINER_MARKER: {
-					// Keep track of current container
-					auto index = read<uint32_t>();
-					// offset points to command, command has size 6
-					_container.push(index);
-
-					// Increment visit count
-					if (uint8_t(flag)
-					    & (uint8_t(CommandFlag::CONTAINER_MARKER_TRACK_VISITS)
-					       | uint8_t(CommandFlag::CONTAINER_MARKER_TRACK_TURNS))) {
-						_globals->visit(index);
-					}
-					if (flag & CommandFlag::CONTAINER_MARKER_IS_KNOT) {
-						_current_knot_id = index;
-						_entered_knot    = true;
-					}
+template<>
+void runner_impl::execute<Command::VAR_COMPARE>(const instruction& inst)
+{
+	const instruction& rhs = _story->instruction_at(_ptr);
+	const instruction& op  = _story->instruction_at(_ptr + CommandSize<uint32_t>);
+	_ptr += 2 * CommandSize<uint32_t>;
+
+	const value* val = get_var(inst.arg.uint, inst.slot);
+	inkAssert(val != nullptr, "Could not find variable!");
+	if (val->type() == value_type::int32) {
+		_eval.push(
+		    value{}.set<value_type::boolean>(compare(op.cmd, val->get<value_type::int32>(), rhs.arg.sint))
+		);
+	} else {
+		// let the executer cast the operands
+		_eval.push(*val);
+		_eval.push(value{}.set<value_type::int32>(static_cast<int32_t>(rhs.arg.sint)));
+		_operations(op.cmd, _eval);
+	}
+}
 
-				} break;
-				case Command::END_CONTAINER_MARKER: {
-					container_t index = read<container_t>();
-					inkAssert(_container.top() == index, "Leaving container we are not in!");
-
-					// Move up out of the current container
-					_container.pop();
-
-					// SPECIAL: If we've popped all containers, then there's an implied
-					// 'done' command or return
-					if (_container.empty()) {
-						_is_falling = false;
-
-						frame_type type;
-						if (! _threads.empty()) {
-							on_done(false);
-							break;
-						} else if (_stack.has_frame(&type) && type == frame_type::function) // implicit return
-						                                                                    // is only for
-						                                                                    // functions
-						{
-							// push null and return
-							_eval.push(values::null);
-
-							// HACK
-							_ptr += sizeof(Command) + sizeof(CommandFlag);
-							execute_return();
-						} else if (_ptr == _story->end()) { // check needed, because it colud exist an unnamed
-							                                  // toplevel container (empty named container stack
-							                                  // != empty container stack)
-							on_done(true);
-						}
-					}
-				} break;
-				case Command::VISIT: {
-					read<uint32_t>();
-					// Push the visit count for the current container to the top
-					//  is 0-indexed for some reason. idk why but this is what ink expects
-					_eval.push(value{}.set<value_type::int32>(
-					    static_cast<int32_t>(_globals->visits(_container.top()) - 1)
-					));
-				} break;
-				case Command::TURN: {
-					read<uint32_t>();
-					_eval.push(value{}.set<value_type::int32>(static_cast<int32_t>(_globals->turns())));
-				} break;
-				case Command::SEQUENCE: {
-					read<uint32_t>();
-					// TODO: The C# ink runtime does a bunch of fancy logic
-					//  to make sure each element is picked at least once in every
-					//  iteration loop. I don't feel like replicating that right now.
-					// So, let's just return a random number and *shrug*
-					int sequenceLength = _eval.pop().get<value_type::int32>();
-					/* shuffel index */
-					_eval.pop();
-
-
-					_eval.push(value{}.set<value_type::int32>(static_cast<int32_t>(_rng.rand(sequenceLength)))
-					);
-				} break;
-				case Command::SEED: {
-					read<uint32_t>();
-					int32_t seed = _eval.pop().get<value_type::int32>();
-					_rng.srand(seed);
+template<>
+void runner_impl::execute<Command::VISIT_COMPARE>(const instruction&)
+{
+	const instruction& rhs = _story->instruction_at(_ptr);
+	const instruction& op  = _story->instruction_at(_ptr + CommandSize<uint32_t>);
+	_ptr += 2 * CommandSize<uint32_t>;
+
+	int32_t visits = static_cast<int32_t>(_globals->visits(_container.top()) - 1);
+	_eval.push(value{}.set<value_type::boolean>(compare(op.cmd, visits, rhs.arg.sint)));
+}
+
+template<>
+void runner_impl::execute<Command::READ_COUNT_COMPARE>(const instruction& inst)
+{
+	const instruction& rhs = _story->instruction_at(_ptr);
+	const instruction& op  = _story->instruction_at(_ptr + CommandSize<uint32_t>);
+	_ptr += 2 * CommandSize<uint32_t>;
+
+	int32_t visits = static_cast<int32_t>(_globals->visits(inst.arg.uint));
+	_eval.push(value{}.set<value_type::boolean>(compare(op.cmd, visits, rhs.arg.sint)));
+}
+
+template<>
+void runner_impl::execute<Command::STR_NEWLINE>(const instruction& inst)
+{
+	const instruction& newline = _story->instruction_at(_ptr);
+	_ptr += CommandSize<uint32_t>;
+
+	execute<Command::STR>(inst);
+	execute<Command::NEWLINE>(newline);
+}
+
+template<>
+void runner_impl::execute<Command::EVAL_PUSH>(const instruction&)
+{
+	const instruction& push = _story->instruction_at(_ptr);
+	_ptr += 2 * CommandSize<uint32_t>;
+
+	_evaluation_mode = true;
+	switch (push.cmd) {
+		case Command::STR: execute<Command::STR>(push); break;
+		case Command::INT: execute<Command::INT>(push); break;
+		case Command::BOOL: execute<Command::BOOL>(push); break;
+		case Command::FLOAT: execute<Command::FLOAT>(push); break;
+		case Command::LIST: execute<Command::LIST>(push); break;
+		case Command::DIVERT_VAL: execute<Command::DIVERT_VAL>(push); break;
+		case Command::VALUE_POINTER: execute<Command::VALUE_POINTER>(push); break;
+		case Command::PUSH_VARIABLE_VALUE: execute<Command::PUSH_VARIABLE_VALUE>(push); break;
+		case Command::VISIT: execute<Command::VISIT>(push); break;
+		case Command::TURN: execute<Command::TURN>(push); break;
+		case Command::READ_COUNT: execute<Command::READ_COUNT>(push); break;
+		default: inkFail("Superinstruction with unexpected push!");
+	}
+	_evaluation_mode = false;
+}
+
+// Dispatch table from command to handler, built once at compile time
+struct runner_impl::handler_table {
+	handler_t entries[static_cast<size_t>(Command::NUM_COMMANDS)];
+
+	constexpr handler_table()
+	    : entries{}
+	{
+		fill<0>();
+	}
+
+	template<size_t I>
+	constexpr void fill()
+	{
+		entries[I] = &runner_impl::execute<static_cast<Command>(I)>;
+		if constexpr (I + 1 < static_cast<size_t>(Command::NUM_COMMANDS)) {
+			fill<I + 1>();
+		}
+	}
+};
+
+void runner_impl::step()
+{
+#ifdef INK_ENABLE_EXCEPTIONS
+	try {
+#endif
+		inkAssert(_ptr != nullptr, "Can not step! Do not have a valid pointer");
+
+		// Load current command, already decoded by the story
+		const instruction& inst = _story->instruction_at(_ptr);
+		_ptr += CommandSize<uint32_t>;
 
 #ifdef INK_ENABLE_STL
-					if (_debug_stream != nullptr) {
-						*_debug_stream << "seed " << seed;
-					}
+		if (_debug_stream != nullptr) {
+			*_debug_stream << "cmd " << inst.cmd << " flags " << inst.flag << " ";
+		}
 #endif
 
-					_eval.push(values::null);
-				} break;
-
-				case Command::READ_COUNT: {
-					// Get container index
-					container_t container = read<container_t>();
-
-					// Push the read count for the requested container index
-					_eval.push(value{}.set<value_type::int32>(static_cast<int32_t>(_globals->visits(container)
-					)));
-				} break;
-				case Command::TAG: {
-					inkFail("Command::TAG is Deprecated!");
-					read<uint32_t>();
-					add_tag(read<const char*>(), tags_level::UNKNOWN);
-				} break;
-				default: inkAssert(false, "Unrecognized command!"); break;
-			}
+		// If we're falling and we hit a non-fallthrough command, stop the fall.
+		if (_is_falling
+		    && ! (
+		        (inst.cmd == Command::DIVERT && inst.flag & CommandFlag::DIVERT_IS_FALLTHROUGH)
+		        || inst.cmd == Command::END_CONTAINER_MARKER
+		    )) {
+			_is_falling = false;
+			set_done_ptr(nullptr);
 		}
 
+		// Dispatch to the command handler
+		static constexpr handler_table handlers{};
+		inkAssert(inst.cmd < Command::NUM_COMMANDS, "Unrecognized command!");
+		(this->*handlers.entries[static_cast<size_t>(inst.cmd)])(inst);
+
 #ifdef INK_ENABLE_STL
 		if (_debug_stream != nullptr) {
 			*_debug_stream << std::endl;
@@ -8,6 +8,7 @@
 
 #include "value.h"
 #include "system.h"
+#include "command.h"
 #include "output.h"
 #include "stack.h"
 #include "choice.h"
@@ -30,6 +31,7 @@
 namespace ink::runtime::internal
 {
 class story_impl;
+struct instruction;
 class globals_impl;
 class snapshot_impl;
 
@@ -128,6 +130,10 @@ public:
 	// c-style getline
 	virtual const char* getline_alloc() override;
 
+	// getline without allocation
+	virtual bool getline(char* buffer, size_t capacity, size_t* needed) override;
+	virtual void getline(line_callback callback, void* context) override;
+
 	// move to path
 	virtual bool move_to(hash_t path) override;
 
@@ -159,6 +165,9 @@ private:
 	// Advances the interpreter by a line. This fills the output buffer
 	void advance_line();
 
+	// Chooses the fallback choice if needed, after a line was taken from the output
+	void finish_line();
+
 	// Steps the interpreter a single instruction and returns
 	//  when it has hit a new line
 	bool line_step();
@@ -166,6 +175,13 @@ private:
 	// Steps the interpreter a single instruction
 	void step();
 
+	// Executes a single decoded instruction. One specialization per command, step() dispatches
+	//  through a table indexed by command
+	template<Command C>
+	void execute(const instruction& inst);
+	using handler_t = void (runner_impl::*)(const instruction&);
+	struct handler_table;
+
 	// Resets the runtime
 	void reset();
 
@@ -186,6 +202,9 @@ private:
 	template<Scope Hint = Scope::NONE>
 	void         set_var(hash_t variableName, const value& val, bool is_redef);
 	const value* dereference(const value& val);
+	// variable referenced by an instruction, slot is the global slot resolved by the story
+	const value* get_var(hash_t variableName, uint32_t slot);
+	void         set_global(uint32_t slot, const value& val, bool is_redef);
 
 	enum class change_type {
 		no_change,
@@ -215,6 +234,12 @@ private:
 	// Fetch string only tags at Tag/Global level
 	void fetch_tags(ip_t begin);
 
+	// Builds a chain of string additions `a + b + c ...` as one string instead of allocating each
+	// intermediate result. false if the addition is no string concatenation.
+	bool concat_chain();
+	// Position of the next addition, if the instructions until then only push its right operand
+	ip_t next_concat_add() const;
+
 	// Special code for jumping from the current IP to another.
 	// preserve_turns: if true, existing turns-since counters on visited knots are not reset
 	// (used during snapshot migration to keep the restored turn values intact).
@@ -360,6 +385,9 @@ private:
 
 	bool _saved = false;
 
+	// a line which did not fit into the buffer passed to getline is kept in the output
+	bool _line_pending = false;
+
 	prng _rng;
 
 #ifdef INK_ENABLE_STL
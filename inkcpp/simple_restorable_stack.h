@@ -34,6 +34,8 @@ public:
 	}
 
 	void     push(const T& value);
+	// Same as popping all values and pushing count values in order
+	void     assign(const T* values, size_t count);
 	T        pop();
 	const T& top() const;
 
@@ -136,6 +138,29 @@ inline void simple_restorable_stack<T>::push(const T& value)
 	_buffer[_pos++] = value;
 }
 
+template<typename T>
+inline void simple_restorable_stack<T>::assign(const T* values, size_t count)
+{
+	_pos = 0;
+
+	// Keep saved data, start behind it
+	if (_save != InvalidIndex) {
+		_jump = 0;
+		_pos  = _save;
+	}
+	if (count == 0) {
+		return;
+	}
+
+	while (_pos + count > _size) {
+		overflow(_buffer, _size);
+	}
+	for (size_t i = 0; i < count; ++i) {
+		inkAssert(values[i] != _null, "Can not push a 'null' value onto the stack.");
+		_buffer[_pos++] = values[i];
+	}
+}
+
 template<typename T>
 inline T simple_restorable_stack<T>::pop()
 {
@@ -9,6 +9,8 @@
 #include "story_impl.h"
 #include "globals_impl.h"
 #include "runner_impl.h"
+#include "file_mapping.h"
+#include "compression.h"
 
 #include <cstring>
 #ifdef INK_ENABLE_STL
@@ -22,6 +24,15 @@ snapshot* snapshot::from_binary(const unsigned char* data, size_t length, bool f
 	return new internal::snapshot_impl(data, length, freeOnDestroy);
 }
 
+snapshot* snapshot::from_delta(const snapshot& base, const unsigned char* data, size_t length)
+{
+	internal::snapshot_delta delta(data, length, false);
+	if (! delta.is_valid()) {
+		return nullptr;
+	}
+	return delta.apply(base);
+}
+
 #ifdef INK_ENABLE_STL
 snapshot* snapshot::from_file(const char* filename)
 {
@@ -39,6 +50,16 @@ snapshot* snapshot::from_file(const char* filename)
 	return from_binary(data, length);
 }
 
+snapshot* snapshot::from_file_mapped(const char* filename)
+{
+	size_t               length = 0;
+	const unsigned char* data   = internal::map_file(filename, length);
+	if (data == nullptr) {
+		return from_file(filename);
+	}
+	return internal::snapshot_impl::from_mapping(data, length);
+}
+
 void snapshot::write_to_file(const char* filename) const
 {
 	std::ofstream ofs(filename, std::ios::binary);
@@ -54,9 +75,14 @@ namespace ink::runtime::internal
 {
 snapshot_impl::~snapshot_impl()
 {
-	if (_managed) {
+	if (_mapped) {
+		unmap_file(_file, _length);
+	} else if (_managed) {
 		delete[] _file;
 	}
+	if (_data != _file) {
+		delete[] _data;
+	}
 	if (old_ref_table) {
 		delete old_ref_table;
 	}
@@ -76,75 +102,408 @@ bool snapshot_impl::can_be_migrated(const story& story) const
 
 const unsigned char* snapshot_impl::get_data() const { return _file; }
 
+snapshot_impl* snapshot_impl::from_mapping(const unsigned char* data, size_t length)
+{
+	snapshot_impl* result = new snapshot_impl(data, length, false);
+	result->_mapped       = true;
+	return result;
+}
+
 size_t snapshot_impl::get_data_len() const { return _length; }
 
-snapshot_impl::snapshot_impl(const globals_impl& globals)
-    : _managed{true}
+void snapshot_impl::measure(
+    const globals_impl& globals, snapshot_interface::snapper& snapper, layout& out
+)
 {
-	snapshot_interface::snapper snapper(globals.strings(), globals._owner->string(0));
-	bool                        migratable = globals.can_be_migrated();
-	size_t                      runner_cnt = 0;
+	// zero the padding as well, so equal states result in equal snapshots
+	memset(&out.head, 0, sizeof(out.head));
+	out.head.version = snapper.compact ? compact_version : plain_version;
 
-	_length = globals.snap(nullptr, snapper);
+	bool   migratable = globals.can_be_migrated();
+	size_t runner_cnt = 0;
+	out.sizes.clear();
+	out.sizes.push() = globals.snap(nullptr, snapper);
+	size_t length    = out.sizes.back();
 	for (auto node = globals._runners_start; node; node = node->next) {
-		_length += node->object->snap(nullptr, snapper);
+		out.sizes.push() = node->object->snap(nullptr, snapper);
+		length += out.sizes.back();
 		migratable = migratable && node->object->can_be_migrated();
 		++runner_cnt;
 	}
 	if (migratable) {
-		_length += globals._owner->list_meta_size();
+		out.sizes.push() = globals._owner->list_meta_size();
+		length += out.sizes.back();
 	}
 
-	_length             = file_size(_length, runner_cnt, migratable);
-	_header.length      = _length;
-	_header.num_runners = runner_cnt;
-	_header.hash        = globals._owner->hash();
-	_header.migratable  = migratable;
-	unsigned char* data = new unsigned char[_length];
-	_file               = data;
-	unsigned char* ptr  = data;
-	// write header
-	memcpy(ptr, &_header, sizeof(_header));
-	// write lookup table
+	out.head.length      = file_size(length, runner_cnt, migratable);
+	out.head.num_runners = runner_cnt;
+	out.head.hash        = globals._owner->hash();
+	out.head.migratable  = migratable;
+}
+
+size_t snapshot_impl::write_head(unsigned char* data, const layout& layout)
+{
+	unsigned char* ptr = data;
+	memcpy(ptr, &layout.head, sizeof(header));
 	ptr += sizeof(header);
-	{
-		size_t offset = static_cast<size_t>(
-		    (ptr - data) + (_header.num_runners + 1 + migratable) * sizeof(size_t)
-		);
+
+	// lookup table with the offset of each section
+	size_t offset = sizeof(header) + layout.sizes.size() * sizeof(size_t);
+	for (size_t i = 0; i < layout.sizes.size(); ++i) {
 		memcpy(ptr, &offset, sizeof(offset));
 		ptr += sizeof(offset);
-		offset += globals.snap(nullptr, snapper);
-		for (auto node = globals._runners_start; node; node = node->next) {
-			memcpy(ptr, &offset, sizeof(offset));
-			ptr += sizeof(offset);
-			offset += node->object->snap(nullptr, snapper);
-		}
-		if (migratable) {
-			memcpy(ptr, &offset, sizeof(offset));
-			ptr += sizeof(offset);
-			offset += globals._owner->list_meta_size();
-		}
+		offset += layout.sizes[i];
 	}
+	return static_cast<size_t>(ptr - data);
+}
+
+unsigned char*
+    snapshot_impl::compress(const unsigned char* data, size_t length, size_t& file_length)
+{
+	// the header stays uncompressed, so the version can be read before expanding
+	unsigned char* file = new unsigned char[sizeof(header) + compressed_bound(length - sizeof(header))];
+	memcpy(file, data, sizeof(header));
+	file_length = sizeof(header)
+	            + compress_chunk(data + sizeof(header), length - sizeof(header), file + sizeof(header));
+	return file;
+}
+
+snapshot_impl::snapshot_impl(const globals_impl& globals, bool compact)
+    : _managed{true}
+{
+	// string ids are computed once for the whole snapshot
+	string_ids                  ids(globals.strings());
+	snapshot_interface::snapper snapper(ids, globals._owner->string(0));
+	snapper.compact = compact;
 
+	// remember section sizes to fill the offset table without measuring again
+	layout layout;
+	measure(globals, snapper, layout);
+	_header             = layout.head;
+	_length             = _header.length;
+	unsigned char* data = new unsigned char[_length];
+	_file               = data;
+	_data               = data;
+
+	unsigned char* ptr = data + write_head(data, layout);
 	ptr += globals.snap(ptr, snapper);
 	for (auto node = globals._runners_start; node; node = node->next) {
 		ptr += node->object->snap(ptr, snapper);
 	}
-	if (migratable) {
+	if (_header.migratable) {
 		memcpy(ptr, globals._owner->list_meta(), globals._owner->list_meta_size());
 		ptr += globals._owner->list_meta_size();
 	}
+	if (compact) {
+		_file = compress(data, _header.length, _length);
+	}
 }
 
+void snapshot_impl::write(const globals_impl& globals, sink& out, bool compact)
+{
+	string_ids                  ids(globals.strings());
+	snapshot_interface::snapper snapper(ids, globals._owner->string(0));
+	snapper.compact = compact;
+
+	layout layout;
+	measure(globals, snapper, layout);
+
+	// one scratch buffer, large enough for the head and every section
+	size_t head_size = sizeof(header) + layout.sizes.size() * sizeof(size_t);
+	size_t capacity  = head_size;
+	for (size_t size : layout.sizes) {
+		capacity = size > capacity ? size : capacity;
+	}
+	unsigned char* buffer = new unsigned char[capacity];
+	// compact snapshots compress each section into a chunk of its own
+	unsigned char* packed = compact ? new unsigned char[compressed_bound(capacity)] : nullptr;
+	auto emit = [&](const void* data, size_t length) {
+		if (compact) {
+			length = compress_chunk(static_cast<const unsigned char*>(data), length, packed);
+			data   = packed;
+		}
+		out.write(data, length);
+	};
+
+	write_head(buffer, layout);
+	if (compact) {
+		// the header stays uncompressed
+		out.write(buffer, sizeof(header));
+		emit(buffer + sizeof(header), head_size - sizeof(header));
+	} else {
+		out.write(buffer, head_size);
+	}
+	emit(buffer, globals.snap(buffer, snapper));
+	for (auto node = globals._runners_start; node; node = node->next) {
+		emit(buffer, node->object->snap(buffer, snapper));
+	}
+	if (layout.head.migratable) {
+		emit(globals._owner->list_meta(), globals._owner->list_meta_size());
+	}
+	delete[] buffer;
+	delete[] packed;
+}
+
+void snapshot_impl::write(sink& out) const { out.write(_file, _length); }
+
 snapshot_impl::snapshot_impl(const unsigned char* data, size_t length, bool managed)
     : _file{data}
     , _length{length}
+    , _data{data}
     , _managed{managed}
 {
 	const unsigned char* ptr = data;
+	if (_length < sizeof(header)) {
+		release();
+		inkFail("Snapshot is too short");
+		return;
+	}
 	memcpy(&_header, ptr, sizeof(_header));
-	inkAssert(_header.length == _length, "Corrupted file length");
-	inkAssert(_header.version == decltype(_header){}.version, "Snapshot version missmatch");
+	uint32_t magic;
+	memcpy(&magic, ptr, sizeof(magic));
+	if (magic == snapshot_delta::magic) {
+		release();
+		inkFail("Delta snapshots have to be restored with snapshot::from_delta()");
+		return;
+	}
+	if (_header.version < min_version || _header.version > compact_version) {
+		release();
+		inkFail("Snapshot version missmatch");
+		return;
+	}
+	if (_header.version < compact_version) {
+		if (_header.length != _length) {
+			release();
+			inkFail("Corrupted file length");
+		}
+		return;
+	}
+
+	// expand the chunks behind the header
+	if (_header.length < sizeof(header)) {
+		release();
+		inkFail("Corrupted file length");
+		return;
+	}
+	unsigned char* expanded = new unsigned char[_header.length];
+	_data                   = expanded;
+	unsigned char* out      = expanded + sizeof(header);
+	memcpy(expanded, data, sizeof(header));
+	ptr                      = data + sizeof(header);
+	const unsigned char* end = data + _length;
+	while (ptr != nullptr && ptr < end) {
+		ptr = expand_chunk(ptr, end, out, expanded + _header.length);
+	}
+	if (ptr != end || out != expanded + _header.length) {
+		release();
+		inkFail("Corrupted compact snapshot");
+	}
+}
+
+void snapshot_impl::release()
+{
+	// an assertion may throw, the destructor would not run then
+	if (_data != _file) {
+		delete[] _data;
+	}
+	if (_managed) {
+		delete[] _file;
+	}
+	_file    = nullptr;
+	_data    = nullptr;
+	_length  = 0;
+	_managed = false;
+	memset(&_header, 0, sizeof(_header));
+}
+
+snapshot_delta::snapshot_delta(const snapshot& base, const snapshot& current)
+    : _managed{true}
+{
+	memset(&_header, 0, sizeof(_header));
+	_header.magic           = magic;
+	_header.base_hash       = hash_data(base.get_data(), base.get_data_len());
+	_header.base_length     = base.get_data_len();
+	_header.snapshot_length = current.get_data_len();
+	_header.num_runners     = current.num_runners();
+	_header.migratable      = current.can_be_migrated();
+
+	const size_t ops_length = encode(
+	    base.get_data(), base.get_data_len(), current.get_data(), current.get_data_len(), nullptr
+	);
+	_length             = sizeof(header) + ops_length;
+	_header.length      = _length;
+	unsigned char* data = new unsigned char[_length];
+	memcpy(data, &_header, sizeof(header));
+	encode(
+	    base.get_data(), base.get_data_len(), current.get_data(), current.get_data_len(),
+	    data + sizeof(header)
+	);
+	_file = data;
+}
+
+snapshot_delta::snapshot_delta(const unsigned char* data, size_t length, bool managed)
+    : _file{data}
+    , _length{length}
+    , _managed{managed}
+{
+	memset(&_header, 0, sizeof(_header));
+	if (_length >= sizeof(header)) {
+		memcpy(&_header, data, sizeof(_header));
+	}
+}
+
+snapshot_delta::~snapshot_delta()
+{
+	if (_managed) {
+		delete[] _file;
+	}
+}
+
+size_t snapshot_delta::encode(
+    const unsigned char* base, size_t base_length, const unsigned char* data, size_t length,
+    unsigned char* out
+)
+{
+	constexpr uint32_t npos         = ~0U;
+	unsigned char*     ptr          = out;
+	bool               should_write = out != nullptr;
+
+	// Index the blocks of the base by content, identical blocks are only stored once
+	const size_t num_blocks = base_length / block_size;
+	size_t       capacity   = 16;
+	while (capacity < num_blocks * 2) {
+		capacity *= 2;
+	}
+	const size_t mask  = capacity - 1;
+	uint32_t*    index = new uint32_t[capacity];
+	for (size_t i = 0; i < capacity; ++i) {
+		index[i] = npos;
+	}
+	for (size_t b = 0; b < num_blocks; ++b) {
+		const unsigned char* block = base + b * block_size;
+		size_t               slot  = hash_data(block, block_size) & mask;
+		while (index[slot] != npos && memcmp(base + index[slot] * block_size, block, block_size) != 0) {
+			slot = (slot + 1) & mask;
+		}
+		if (index[slot] == npos) {
+			index[slot] = static_cast<uint32_t>(b);
+		}
+	}
+	auto find = [&](const unsigned char* block) {
+		size_t slot = hash_data(block, block_size) & mask;
+		while (index[slot] != npos) {
+			if (memcmp(base + index[slot] * block_size, block, block_size) == 0) {
+				return index[slot];
+			}
+			slot = (slot + 1) & mask;
+		}
+		return npos;
+	};
+
+	auto insert = [&](size_t start, size_t end) {
+		if (end > start) {
+			ptr = snapshot_interface::snap_write(ptr, op::insert, should_write);
+			ptr = snapshot_interface::snap_write(ptr, static_cast<uint32_t>(end - start), should_write);
+			ptr = snapshot_interface::snap_write(ptr, data + start, end - start, should_write);
+		}
+	};
+
+	size_t pending = 0; // start of bytes not yet written
+	size_t pos     = 0;
+	while (pos + block_size <= length) {
+		uint32_t block = find(data + pos);
+		if (block == npos) {
+			++pos;
+			continue;
+		}
+
+		// grow the match in both directions
+		size_t base_pos = block * block_size;
+		size_t match    = block_size;
+		while (pos > pending && base_pos > 0 && data[pos - 1] == base[base_pos - 1]) {
+			--pos;
+			--base_pos;
+			++match;
+		}
+		while (pos + match < length && base_pos + match < base_length
+		       && data[pos + match] == base[base_pos + match]) {
+			++match;
+		}
+
+		insert(pending, pos);
+		ptr = snapshot_interface::snap_write(ptr, op::copy, should_write);
+		ptr = snapshot_interface::snap_write(ptr, static_cast<uint32_t>(match), should_write);
+		ptr = snapshot_interface::snap_write(ptr, static_cast<uint32_t>(base_pos), should_write);
+		pos += match;
+		pending = pos;
+	}
+	insert(pending, length);
+
+	delete[] index;
+	return static_cast<size_t>(ptr - out);
+}
+
+snapshot_impl* snapshot_delta::apply(const snapshot& base) const
+{
+	const unsigned char* base_data = base.get_data();
+	if (base.get_data_len() != _header.base_length
+	    || hash_data(base_data, _header.base_length) != _header.base_hash) {
+		return nullptr;
+	}
+
+	// the delta is stored data, so every read is checked against its end
+	unsigned char*       data = new unsigned char[_header.snapshot_length];
+	unsigned char*       out  = data;
+	const unsigned char* ptr  = _file + sizeof(header);
+	const unsigned char* end  = _file + _length;
+	auto                 left = [&]() {
+		return static_cast<size_t>(end - ptr);
+	};
+	bool corrupted = false;
+	while (ptr < end) {
+		op       kind;
+		uint32_t length;
+		uint32_t offset;
+		if (left() < sizeof(kind) + sizeof(length)) {
+			corrupted = true;
+			break;
+		}
+		ptr = snapshot_interface::snap_read(ptr, kind);
+		ptr = snapshot_interface::snap_read(ptr, length);
+		if (length > _header.snapshot_length - static_cast<size_t>(out - data)) {
+			corrupted = true;
+			break;
+		}
+		if (kind == op::copy) {
+			if (left() < sizeof(offset)) {
+				corrupted = true;
+				break;
+			}
+			ptr = snapshot_interface::snap_read(ptr, offset);
+			// without a sum, which could wrap around
+			if (offset > _header.base_length || length > _header.base_length - offset) {
+				corrupted = true;
+				break;
+			}
+			memcpy(out, base_data + offset, length);
+		} else if (kind == op::insert) {
+			if (length > left()) {
+				corrupted = true;
+				break;
+			}
+			memcpy(out, ptr, length);
+			ptr += length;
+		} else {
+			corrupted = true;
+			break;
+		}
+		out += length;
+	}
+	if (corrupted || out != data + _header.snapshot_length) {
+		delete[] data;
+		return nullptr;
+	}
+	return new snapshot_impl(data, _header.snapshot_length, true);
 }
 
 size_t snap_choice::snap(unsigned char* data, const snapper& snapper) const
@@ -160,11 +519,22 @@ size_t snap_choice::snap(unsigned char* data, const snapper& snapper) const
 	} else {
 		ptr                         = snap_write(ptr, true, should_write);
 		std::uintptr_t offset_start = _tags_start - snapper.runner_tags;
-		ptr                         = snap_write(ptr, offset_start, should_write);
 		std::uintptr_t offset_end   = _tags_end - snapper.runner_tags;
-		ptr                         = snap_write(ptr, offset_end, should_write);
+		if (snapper.compact) {
+			ptr = snap_write_varint(ptr, static_cast<size_t>(offset_start), should_write);
+			ptr = snap_write_varint(ptr, static_cast<size_t>(offset_end), should_write);
+		} else {
+			ptr = snap_write(ptr, offset_start, should_write);
+			ptr = snap_write(ptr, offset_end, should_write);
+		}
+	}
+	// the size of a varint depends on the id, so it is also needed when measuring
+	size_t text_id = should_write || snapper.compact ? snapper.strings.get_id(_text) : 0;
+	if (snapper.compact) {
+		ptr = snap_write_varint(ptr, text_id, should_write);
+	} else {
+		ptr = snap_write(ptr, text_id, should_write);
 	}
-	ptr = snap_write(ptr, snapper.strings.get_id(_text), should_write);
 	return static_cast<size_t>(ptr - data);
 }
 
@@ -178,17 +548,26 @@ const unsigned char* snap_choice::snap_load(const unsigned char* data, const loa
 	ptr = snap_read(ptr, has_tags);
 	if (has_tags) {
 		std::uintptr_t offset_start = 0;
-		ptr                         = snap_read(ptr, offset_start);
-		_tags_start                 = loader.runner_tags + offset_start;
 		std::uintptr_t offset_end   = 0;
-		ptr                         = snap_read(ptr, offset_end);
-		_tags_end                   = loader.runner_tags + offset_end;
+		if (loader.compact()) {
+			ptr = snap_read_varint(ptr, offset_start);
+			ptr = snap_read_varint(ptr, offset_end);
+		} else {
+			ptr = snap_read(ptr, offset_start);
+			ptr = snap_read(ptr, offset_end);
+		}
+		_tags_start = loader.runner_tags + offset_start;
+		_tags_end   = loader.runner_tags + offset_end;
 	} else {
 		_tags_start = nullptr;
 		_tags_end   = nullptr;
 	}
 	size_t string_id;
-	ptr   = snap_read(ptr, string_id);
+	if (loader.compact()) {
+		ptr = snap_read_varint(ptr, string_id);
+	} else {
+		ptr = snap_read(ptr, string_id);
+	}
 	_text = loader.string_table[string_id];
 	return ptr;
 }
@@ -200,9 +579,13 @@ size_t snap_tag::snap(unsigned char* data, const snapper& snapper) const
 	if (_str == nullptr) {
 		ptr = snap_write(ptr, false, should_write);
 	} else {
-		size_t id = snapper.strings.get_id(_str);
+		size_t id = should_write || snapper.compact ? snapper.strings.get_id(_str) : 0;
 		ptr       = snap_write(ptr, true, should_write);
-		ptr       = snap_write(ptr, id, should_write);
+		if (snapper.compact) {
+			ptr = snap_write_varint(ptr, id, should_write);
+		} else {
+			ptr = snap_write(ptr, id, should_write);
+		}
 	}
 	return static_cast<size_t>(ptr - data);
 }
@@ -216,7 +599,11 @@ const unsigned char* snap_tag::snap_load(const unsigned char* data, const loader
 		_str = nullptr;
 	} else {
 		size_t id;
-		ptr  = snap_read(ptr, id);
+		if (loader.compact()) {
+			ptr = snap_read_varint(ptr, id);
+		} else {
+			ptr = snap_read(ptr, id);
+		}
 		_str = loader.string_table[id];
 	}
 	return ptr;
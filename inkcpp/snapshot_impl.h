@@ -87,28 +87,50 @@ public:
 
 	const unsigned char* get_data() const override;
 	size_t               get_data_len() const override;
+	void                 write(sink& out) const override;
 
-	snapshot_impl(const globals_impl&);
+	// compact snapshots use the compact_version encoding and are compressed
+	snapshot_impl(const globals_impl&, bool compact);
+	// serializes globals and their runners section by section into out, without building the
+	// whole snapshot in memory. Sections are measured first to write the header.
+	static void write(const globals_impl&, sink& out, bool compact);
 	// write down all allocated strings
 	// replace pointer with idx
 	// reconsrtuct static strings index
 	// list_table _data & _entry_state
 	snapshot_impl(const unsigned char* data, size_t length, bool managed);
+	// snapshot of a file mapping created with map_file, which is unmapped on destruction
+	static snapshot_impl* from_mapping(const unsigned char* data, size_t length);
 
-	const unsigned char* get_globals_snap() const { return _file + get_offset(0); }
+	const unsigned char* get_globals_snap() const { return _data + get_offset(0); }
 
-	const unsigned char* get_runner_snap(size_t idx) const { return _file + get_offset(idx + 1); }
+	const unsigned char* get_runner_snap(size_t idx) const { return _data + get_offset(idx + 1); }
 
-	const unsigned char* get_list_metadata() const { return _file + get_offset(num_runners() + 1); }
+	const unsigned char* get_list_metadata() const { return _data + get_offset(num_runners() + 1); }
+
+	// end of the expanded snapshot data
+	const unsigned char* get_data_end() const { return _data + _header.length; }
 
 	size_t num_runners() const override { return _header.num_runners; }
 
 	bool can_be_migrated() const override { return _header.migratable; }
 
+	const snapshot_impl* loadable() const override { return this; }
+
 	bool can_be_migrated(const story&) const;
 
 	hash_t hash() const { return _header.hash; }
 
+	// format version the snapshot was written in
+	size_t version() const { return _header.version; }
+
+	// oldest format version which can still be loaded
+	static constexpr size_t min_version = 1;
+	// format version of plain snapshots
+	static constexpr size_t plain_version = 2;
+	// varints, runs of equal visit counts and compressed sections
+	static constexpr size_t compact_version = 3;
+
 	mutable const list_table* old_ref_table = nullptr;
 
 private:
@@ -120,24 +142,109 @@ private:
 	mutable managed_array<int, true, 5, true>   list_value_matches_table;
 	const unsigned char*                        _file;
 	size_t                                      _length;
+	// expanded snapshot, differs from _file for compressed snapshots and is owned then
+	const unsigned char*                        _data;
 	bool                                        _managed;
+	bool                                        _mapped = false;
 	static size_t                               file_size(size_t, size_t, bool);
 
+	// kept trivial, so it can be zeroed including its padding
 	struct header {
 		size_t num_runners;
 		size_t length;
 		hash_t hash;
 		bool   migratable;
-		size_t version = 1;
+		size_t version;
 	} _header;
 
+	// header and section sizes of a snapshot about to be written
+	struct layout {
+		header                               head;
+		managed_array<size_t, true, 4, true> sizes;
+	};
+
+	static void   measure(const globals_impl&, snapshot_interface::snapper&, layout& out);
+	// compresses the expanded snapshot data behind the header, returns the owned file
+	static unsigned char* compress(const unsigned char* data, size_t length, size_t& file_length);
+	// writes header and offset table, returns the number of bytes written
+	static size_t write_head(unsigned char* data, const layout&);
+
+	// releases the data of a snapshot which can not be loaded, before an assertion is raised
+	void release();
+
 	size_t get_offset(size_t idx) const
 	{
 		inkAssert(
 		    idx <= _header.num_runners + (can_be_migrated() ? 1 : 0),
 		    "Out of Bound access for runner in snapshot."
 		);
-		return reinterpret_cast<const size_t*>(_file + sizeof(header))[idx];
+		return reinterpret_cast<const size_t*>(_data + sizeof(header))[idx];
 	}
 };
+
+/** Snapshot stored as the difference to an earlier snapshot.
+ *
+ * The data is a list of operations which rebuild the full snapshot: copy a range of the base
+ * snapshot or insert new bytes. Ranges are found by looking up blocks of the new snapshot in the
+ * base, so changes which shift the following data (a new string, a longer stack) only cost the
+ * inserted bytes.
+ */
+class snapshot_delta final : public snapshot
+{
+public:
+	snapshot_delta(const snapshot& base, const snapshot& current);
+	snapshot_delta(const unsigned char* data, size_t length, bool managed);
+	~snapshot_delta() override;
+
+	const unsigned char* get_data() const override { return _file; }
+
+	size_t get_data_len() const override { return _length; }
+
+	void write(sink& out) const override { out.write(_file, _length); }
+
+	size_t num_runners() const override { return _header.num_runners; }
+
+	bool can_be_migrated() const override { return _header.migratable; }
+
+	// a delta has to be applied to its base before it can be loaded
+	const snapshot_impl* loadable() const override { return nullptr; }
+
+	// header is complete and fits the data, the operations are only checked by apply()
+	bool is_valid() const { return _header.magic == magic && _header.length == _length; }
+
+	// rebuilds the full snapshot, nullptr if this delta was created against another base or its
+	// operations are corrupted
+	snapshot_impl* apply(const snapshot& base) const;
+
+	static constexpr uint32_t magic = ('I' << 24) | ('N' << 16) | ('K' << 8) | 'D';
+
+private:
+	// block size used to find equal ranges, shorter ranges are inserted
+	static constexpr size_t block_size = 16;
+
+	enum class op : unsigned char {
+		copy,  ///< copy length bytes from offset in base
+		insert ///< insert the following length bytes
+	};
+
+	// writes the operations rebuilding data from base, returns the number of bytes written
+	static size_t encode(
+	    const unsigned char* base, size_t base_length, const unsigned char* data, size_t length,
+	    unsigned char* out
+	);
+
+	struct header {
+		uint32_t magic;
+		hash_t   base_hash;
+		size_t   base_length;
+		size_t   snapshot_length; ///< of the rebuild snapshot
+		size_t   length;
+		size_t   num_runners;
+		bool     migratable;
+	} _header;
+
+	const unsigned char* _file;
+	size_t               _length;
+	bool                 _managed;
+};
 } // namespace ink::runtime::internal
@@ -17,6 +17,7 @@ template<typename, bool, size_t, bool = false>
 class managed_array;
 class snap_tag;
 class string_table;
+class string_ids;
 class value;
 class list_table;
 
@@ -51,12 +52,70 @@ public:
 		return snap_read(ptr, &data, sizeof(data));
 	}
 
+	// LEB128: 7 bits per byte, the high bit marks that another byte follows
+	static constexpr size_t max_varint_size = (sizeof(size_t) * 8 + 6) / 7;
+
+	static size_t varint_size(size_t value)
+	{
+		size_t size = 1;
+		while (value >= 0x80) {
+			value >>= 7;
+			++size;
+		}
+		return size;
+	}
+
+	static unsigned char* snap_write_varint(unsigned char* ptr, size_t value, bool write)
+	{
+		while (value >= 0x80) {
+			if (write) {
+				*ptr = static_cast<unsigned char>(value | 0x80);
+			}
+			++ptr;
+			value >>= 7;
+		}
+		if (write) {
+			*ptr = static_cast<unsigned char>(value);
+		}
+		return ptr + 1;
+	}
+
+	template<typename T>
+	static const unsigned char* snap_read_varint(const unsigned char* ptr, T& data)
+	{
+		size_t   value = 0;
+		unsigned shift = 0;
+		while (*ptr & 0x80) {
+			value |= static_cast<size_t>(*ptr++ & 0x7F) << shift;
+			shift += 7;
+		}
+		value |= static_cast<size_t>(*ptr++) << shift;
+		data = static_cast<T>(value);
+		return ptr;
+	}
+
+	// reads a varint from untrusted data, nullptr if it does not end before end or is too long
+	template<typename T>
+	static const unsigned char*
+	    snap_read_varint(const unsigned char* ptr, const unsigned char* end, T& data)
+	{
+		size_t size = 0;
+		while (size < max_varint_size && ptr + size < end && (ptr[size] & 0x80)) {
+			++size;
+		}
+		if (size == max_varint_size || ptr + size >= end) {
+			return nullptr;
+		}
+		return snap_read_varint(ptr, data);
+	}
+
 	struct snapper {
-		const string_table& strings;
-		const char*         story_string_table;
-		const snap_tag*     runner_tags = nullptr;
+		const string_ids& strings; ///< snapshot ids of runtime strings
+		const char*       story_string_table;
+		const snap_tag*   runner_tags = nullptr;
+		bool              compact     = false; ///< write the compact encoding (version 3)
 
-		snapper(const string_table& strings, const char* story_string_table)
+		snapper(const string_ids& strings, const char* story_string_table)
 		    : strings{strings}
 		    , story_string_table{story_string_table}
 		{
@@ -75,13 +134,14 @@ public:
 		managed_array<int, true, 5, true>&   list_list_matches;
 		managed_array<int, true, 5, true>&   list_value_matches;
 		const list_table*&                   old_ref_table;
+		const size_t                         version; ///< snapshot format the data was written in
 
 		loader(
 		    managed_array<const char*, true, 5>& string_table, const char* story_string_table,
 		    managed_array<int, true, 5, true>& list_old_new_map,
 		    managed_array<int, true, 5, true>& list_list_matches,
 		    managed_array<int, true, 5, true>& list_value_matches, bool migratable,
-		    const list_table*& old_ref_table
+		    const list_table*& old_ref_table, size_t version
 		)
 		    : string_table{string_table}
 		    , story_string_table{story_string_table}
@@ -90,9 +150,13 @@ public:
 		    , list_list_matches(list_list_matches)
 		    , list_value_matches(list_value_matches)
 		    , old_ref_table(old_ref_table)
+		    , version(version)
 		{
 		}
 
+		/// snapshot was written with snapper::compact
+		bool compact() const { return version >= 3; }
+
 		loader()                         = delete;
 		loader& operator=(const loader&) = delete;
 	};
@@ -10,11 +10,17 @@
 #include "snapshot.h"
 #include "snapshot_impl.h"
 #include "snapshot_interface.h"
+#include "file_mapping.h"
 
 namespace ink::runtime
 {
 #ifdef INK_ENABLE_STL
 story* story::from_file(const char* filename) { return new internal::story_impl(filename); }
+
+story* story::from_file_mapped(const char* filename)
+{
+	return new internal::story_impl(filename, true);
+}
 #endif
 
 story* story::from_binary(const unsigned char* data, size_t length, bool freeOnDestroy)
@@ -46,15 +52,21 @@ unsigned char* read_file_into_memory(const char* filename, size_t* read)
 	return data;
 }
 
-story_impl::story_impl(const char* filename)
+story_impl::story_impl(const char* filename, bool map)
     : _file(nullptr)
     , _length(0)
     , _string_table(nullptr)
     , _instruction_data(nullptr)
     , _managed(true)
 {
-	// Load file into memory
-	_file = read_file_into_memory(filename, &_length);
+	// Map file or load it into memory
+	if (map) {
+		_file          = map_file(filename, _length);
+		_mapped_length = _file != nullptr ? _length : 0;
+	}
+	if (_file == nullptr) {
+		_file = read_file_into_memory(filename, &_length);
+	}
 
 	// Find all the right data sections
 	setup_pointers();
@@ -81,12 +93,22 @@ story_impl::story_impl(const unsigned char* binary, size_t len, bool manage /*=
 story_impl::~story_impl()
 {
 	// delete file memory if we're responsible for it
-	if (_file != nullptr && _managed)
+	if (_file != nullptr && _mapped_length > 0)
+		unmap_file(_file, _mapped_length);
+	else if (_file != nullptr && _managed)
 		delete[] _file;
+	delete[] _instructions;
+	delete[] _call_site_names;
+	delete[] _container_at;
+	delete[] _container_path_start;
+	delete[] _container_paths;
 
 	// clear pointers
 	_file             = nullptr;
 	_instruction_data = nullptr;
+	_instructions     = nullptr;
+	_call_site_names  = nullptr;
+	_container_at     = nullptr;
 	_string_table     = nullptr;
 
 	// clear out our reference block
@@ -135,6 +157,15 @@ static const entry* upper_bound(const entry* sorted, uint32_t count, uint32_t ke
 }
 
 container_t story_impl::find_container_for(uint32_t offset) const
+{
+	constexpr uint32_t size = CommandSize<uint32_t>;
+	if (_container_at != nullptr && offset % size == 0 && offset / size <= _num_instructions) {
+		return _container_at[offset / size];
+	}
+	return search_container_for(offset);
+}
+
+container_t story_impl::search_container_for(uint32_t offset) const
 {
 	// Container map contains offsets in even slots, container ids in odd.
 	const container_map_t* entry = upper_bound(_container_map, _container_map_size, offset);
@@ -176,6 +207,21 @@ ip_t story_impl::find_offset_for(hash_t path) const
 	return entry && entry->_hash == path ? _instruction_data + entry->_offset : nullptr;
 }
 
+uint32_t story_impl::find_global_slot(hash_t name) const
+{
+	uint32_t begin = 0;
+	uint32_t end   = _num_globals;
+	while (begin < end) {
+		const uint32_t mid = begin + (end - begin) / 2;
+		if (_globals[mid] < name) {
+			begin = mid + 1;
+		} else {
+			end = mid;
+		}
+	}
+	return begin < _num_globals && _globals[begin] == name ? begin : InvalidSlot;
+}
+
 hash_t story_impl::find_migration_hash(uint32_t offset) const
 {
 	// Callers pass (_ptr - instructions - 6).  For *tracked* containers jump() advances _ptr by 6
@@ -202,7 +248,10 @@ globals story_impl::new_globals()
 
 globals story_impl::new_globals_from_snapshot(const snapshot& data)
 {
-	const snapshot_impl& snapshot = reinterpret_cast<const snapshot_impl&>(data);
+	if (data.loadable() == nullptr) {
+		return globals();
+	}
+	const snapshot_impl& snapshot = *data.loadable();
 	if (! snapshot.can_be_migrated(*this)) {
 		return globals();
 	}
@@ -210,7 +259,8 @@ globals story_impl::new_globals_from_snapshot(const snapshot& data)
 	snapshot.strings().clear();
 	snapshot_interface::loader loader(
 	    snapshot.strings(), _string_table, snapshot.list_list_matches(), snapshot.list_old_new_map(),
-	    snapshot.list_value_matches(), snapshot.can_be_migrated(), snapshot.old_ref_table
+	    snapshot.list_value_matches(), snapshot.can_be_migrated(), snapshot.old_ref_table,
+	    snapshot.version()
 	);
 	auto end = globs.cast<globals_impl>()->snap_load(snapshot.get_globals_snap(), loader);
 	inkAssert(end == snapshot.get_runner_snap(0), "not all data were used for global reconstruction");
@@ -236,7 +286,10 @@ runner story_impl::new_runner(globals store)
 
 runner story_impl::new_runner_from_snapshot(const snapshot& data, globals store, unsigned idx)
 {
-	const snapshot_impl& snapshot = reinterpret_cast<const snapshot_impl&>(data);
+	if (data.loadable() == nullptr) {
+		return runner();
+	}
+	const snapshot_impl& snapshot = *data.loadable();
 	if (store == nullptr)
 		store = new_globals_from_snapshot(snapshot);
 	runner run(new runner_impl(this, store), _block);
@@ -250,12 +303,13 @@ runner story_impl::new_runner_from_snapshot(const snapshot& data, globals store,
 	    snapshot.list_list_matches(),
 	    snapshot.list_value_matches(),
 	    snapshot.can_be_migrated(),
-	    snapshot.old_ref_table
+	    snapshot.old_ref_table,
+	    snapshot.version()
 	};
 	auto end = run.cast<runner_impl>()->snap_load(snapshot.get_runner_snap(idx), loader);
 	inkAssert(
 	    (idx + 1 < snapshot.num_runners() && end == snapshot.get_runner_snap(idx + 1))
-	        || end == snapshot.get_data() + snapshot.get_data_len()
+	        || end == snapshot.get_data_end()
 	        || end == snapshot.get_list_metadata(),
 	    "not all data were used for runner reconstruction"
 	);
@@ -311,6 +365,12 @@ void story_impl::setup_pointers()
 		    = reinterpret_cast<const container_hash_t*>(_file + header._container_hash._start);
 	}
 
+	// Address global variable slots if they exist
+	if (header._variables._bytes) {
+		_num_globals = header._variables._bytes / sizeof(hash_t);
+		_globals     = reinterpret_cast<const hash_t*>(_file + header._variables._start);
+	}
+
 	// Address instructions, which we hope exist!
 	if (header._instructions._bytes)
 		_instruction_data = _file + header._instructions._start;
@@ -324,6 +384,9 @@ void story_impl::setup_pointers()
 	);
 	_length = static_cast<size_t>(_instruction_data + header._instructions._bytes - _file);
 
+	decode_instructions();
+	build_container_index();
+
 	// Debugging info
 	/*{
 	  const uint32_t* iter = nullptr;
@@ -334,4 +397,100 @@ void story_impl::setup_pointers()
 	  }
 	}*/
 }
+
+void story_impl::decode_instructions()
+{
+	if (_instruction_data == nullptr) {
+		return;
+	}
+
+	constexpr size_t size = CommandSize<uint32_t>;
+	_num_instructions     = static_cast<size_t>(end() - _instruction_data) / size;
+	_instructions         = new instruction[_num_instructions];
+
+	ip_t iter = _instruction_data;
+	for (size_t i = 0; i < _num_instructions; ++i, iter += size) {
+		instruction& inst = _instructions[i];
+		inst.cmd          = static_cast<Command>(iter[0]);
+		inst.flag         = static_cast<CommandFlag>(iter[1]);
+		inst.slot         = InvalidSlot;
+		inst.arg.str      = nullptr;
+		memcpy(&inst.arg.uint, iter + sizeof(Command) + sizeof(CommandFlag), sizeof(uint32_t));
+
+		switch (inst.cmd) {
+			// resolve string offsets once instead of on every execution
+			case Command::STR:
+			case Command::STR_NEWLINE: inst.arg.str = string(inst.arg.uint); break;
+			// resolve global variable names to their slot
+			case Command::SET_VARIABLE:
+			case Command::PUSH_VARIABLE_VALUE:
+			case Command::VAR_COMPARE:
+			case Command::DIVERT_TO_VARIABLE: inst.slot = find_global_slot(inst.arg.uint); break;
+			case Command::TUNNEL:
+				if (inst.flag & CommandFlag::TUNNEL_TO_VARIABLE) {
+					inst.slot = find_global_slot(inst.arg.uint);
+				}
+				break;
+			case Command::FUNCTION:
+				if (inst.flag & CommandFlag::FUNCTION_TO_VARIABLE) {
+					inst.slot = find_global_slot(inst.arg.uint);
+				}
+				break;
+			// once-only choices check the visits of their destination every time they are evaluated
+			case Command::CHOICE:
+				if (inst.flag & CommandFlag::CHOICE_IS_ONCE_ONLY) {
+					container_t id = ~0U;
+					inst.container = find_container_id(inst.arg.uint, id) ? id : ~0U;
+				}
+				break;
+			// number external calls, so runners can resolve their function once
+			case Command::CALL_EXTERNAL: inst.call_site = _num_call_sites++; break;
+			default: break;
+		}
+	}
+
+	_call_site_names = new hash_t[_num_call_sites];
+	for (size_t i = 0; i < _num_instructions; ++i) {
+		if (_instructions[i].cmd == Command::CALL_EXTERNAL) {
+			_call_site_names[_instructions[i].call_site] = _instructions[i].arg.uint;
+		}
+	}
+}
+
+void story_impl::build_container_index()
+{
+	if (_instruction_data == nullptr || _num_containers == 0) {
+		return;
+	}
+
+	// innermost container of each instruction, so jumps don't need to search the container map
+	constexpr uint32_t size = CommandSize<uint32_t>;
+	_container_at           = new container_t[_num_instructions + 1];
+	for (size_t i = 0; i <= _num_instructions; ++i) {
+		_container_at[i] = search_container_for(static_cast<uint32_t>(i * size));
+	}
+
+	// ancestor path of each container, to rebuild the container stack without walking parents
+	_container_path_start    = new uint32_t[_num_containers + 1];
+	_container_path_start[0] = 0;
+	for (container_t id = 0; id < _num_containers; ++id) {
+		uint32_t depth = 0;
+		for (container_t p = id; p != ~0U; p = container_data(p)._parent) {
+			++depth;
+		}
+		inkAssert(
+		    config::limitContainerDepth < 0
+		        || depth <= static_cast<uint32_t>(config::limitContainerDepth),
+		    "Container depth limit exceeded by story!"
+		);
+		_container_path_start[id + 1] = _container_path_start[id] + depth;
+	}
+	_container_paths = new container_t[_container_path_start[_num_containers]];
+	for (container_t id = 0; id < _num_containers; ++id) {
+		uint32_t i = _container_path_start[id + 1];
+		for (container_t p = id; p != ~0U; p = container_data(p)._parent) {
+			_container_paths[--i] = p;
+		}
+	}
+}
 } // namespace ink::runtime::internal
@@ -16,12 +16,40 @@
 
 namespace ink::runtime::internal
 {
-// Ink story. Constant once constructed. Can be shared safely between multiple runner instances
+// Instruction as decoded at load time. The runner dispatches on these instead of re-reading
+// the packed command, flag and payload bytes on every step.
+struct instruction {
+	Command     cmd;
+	CommandFlag flag;
+
+	union {
+		// slot of the referenced global variable, InvalidSlot if the instruction is not accessing one
+		uint32_t slot;
+		// destination container of a once-only choice, ~0 if the destination is not counted
+		container_t container;
+		// position of a CALL_EXTERNAL among all external function calls of the story
+		uint32_t call_site;
+	};
+
+	union {
+		uint32_t    uint;
+		int32_t     sint;
+		float       real;
+		const char* str; // string table entry, only for Command::STR
+	} arg;
+};
+
+// Slot of a name which is not a global variable
+constexpr uint32_t InvalidSlot = ~0U;
+
+// Ink story. Constant once constructed. Can be shared safely between multiple runner instances,
+// also on different threads (see INK_ENABLE_THREADS)
 class story_impl : public story
 {
 public:
 #ifdef INK_ENABLE_STL
-	story_impl(const char* filename);
+	// Load story from file, if map is true the file is memory mapped instead of read
+	story_impl(const char* filename, bool map = false);
 #endif
 	// Create story from allocated binary data in memory. If manage is true, this class will delete
 	//  the pointers on destruction
@@ -34,6 +62,15 @@ public:
 
 	inline ip_t end() const { return _file + _length; }
 
+	// Decoded instruction starting at ip
+	const instruction& instruction_at(ip_t ip) const
+	{
+		inkAssert(
+		    ip >= _instruction_data && ip < end(), "Instruction pointer outside of story instructions!"
+		);
+		return _instructions[static_cast<size_t>(ip - _instruction_data) / CommandSize<uint32_t>];
+	}
+
 	inline uint32_t num_containers() const { return _num_containers; }
 
 	const list_flag* lists() const { return _lists; }
@@ -46,6 +83,14 @@ public:
 	// that container.
 	container_t find_container_for(uint32_t offset) const;
 
+	// Containers from the outermost ancestor down to id (inclusive), depth is the number of entries
+	const container_t* container_path(container_t id, uint32_t& depth) const
+	{
+		inkAssert(id < _num_containers, "Container ID %u out of range", ( unsigned ) id);
+		depth = _container_path_start[id + 1] - _container_path_start[id];
+		return _container_paths + _container_path_start[id];
+	}
+
 	// Find the container which starts exactly at offset. Return false if this isn't the start of a
 	// container.
 	bool find_container_id(uint32_t offset, container_t& container_id) const;
@@ -75,6 +120,28 @@ public:
 
 	ip_t find_offset_for(hash_t path) const;
 
+	// Number of global variables declared by the story
+	inline uint32_t num_globals() const { return _num_globals; }
+
+	// Name hashes of all global variables, index is the slot
+	const hash_t* global_names() const { return _globals; }
+
+	// Name hash of the global variable in slot
+	hash_t global_name(uint32_t slot) const
+	{
+		inkAssert(slot < _num_globals, "Global variable slot %u out of range", slot);
+		return _globals[slot];
+	}
+
+	// Slot of the global variable with the given name, or InvalidSlot if it is not a global
+	uint32_t find_global_slot(hash_t name) const;
+
+	// Number of CALL_EXTERNAL instructions in the story
+	uint32_t num_call_sites() const { return _num_call_sites; }
+
+	// Name hash of the function called by each CALL_EXTERNAL, index is the call site
+	const hash_t* call_site_names() const { return _call_site_names; }
+
 	// Find the hash to use for migration at the given instruction offset.
 	// First tries an exact match in _container_hash (handles named but untracked containers such as
 	// unlabeled choice bodies c-0, c-1, etc.), then falls back to find_container_for for positions
@@ -92,6 +159,10 @@ public:
 
 private:
 	void setup_pointers();
+	void decode_instructions();
+	void build_container_index();
+	// binary search in the container map, used to build the dense index
+	container_t search_container_for(uint32_t offset) const;
 
 private:
 	// file information
@@ -117,13 +188,34 @@ private:
 	const container_hash_t* _container_hash      = nullptr;
 	uint32_t                _container_hash_size = 0;
 
+	// Name hashes of global variables, sorted, position is the slot.
+	const hash_t* _globals     = nullptr;
+	uint32_t      _num_globals = 0;
+
 	// instruction info
 	ip_t _instruction_data = nullptr;
 
+	// instructions decoded from _instruction_data, one per packed instruction
+	instruction* _instructions     = nullptr;
+	size_t       _num_instructions = 0;
+
+	// function names of all CALL_EXTERNAL instructions, in the order of the instructions
+	hash_t*  _call_site_names = nullptr;
+	uint32_t _num_call_sites  = 0;
+
+	// innermost container per instruction (plus one entry for the end of the story)
+	container_t* _container_at = nullptr;
+
+	// ancestor paths of all containers, path of container id starts at _container_path_start[id]
+	uint32_t*    _container_path_start = nullptr;
+	container_t* _container_paths      = nullptr;
+
 	// story block used to create various weak pointers
 	ref_block* _block;
 
 	// whether we need to delete our binary data after we destruct
 	bool _managed;
+	// size of the file mapping holding our binary data, 0 if it is no mapping
+	size_t _mapped_length = 0;
 };
 } // namespace ink::runtime::internal
@@ -13,16 +13,13 @@ void ref_block::remove_reference(ref_block*& block)
 	if (block == nullptr)
 		return;
 
-	// If we only have one references left
-	if (block->references <= 1) {
+	// Decrement references. Reading the old count in the same step makes sure only the owner of
+	// the last reference deletes the block, even if other threads release theirs concurrently
+	if (block->references-- <= 1) {
 		// delete the block
 		delete block;
 		block = nullptr;
-		return;
 	}
-
-	// Otherwise, decrement references
-	block->references--;
 }
 
 story_ptr_base::story_ptr_base(internal::ref_block* story)
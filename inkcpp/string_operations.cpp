@@ -52,28 +52,48 @@ namespace casting
 	}
 } // namespace casting
 
-void operation<Command::ADD, value_type::string, void>::operator()(
-    basic_eval_stack& stack, value* vals
-)
+namespace
 {
-	// convert values to strings
-	casting::string_cast lh(vals[0]);
-	casting::string_cast rh(vals[1]);
-
-	// create new string with needed size
-	char* str = _string_table.create(c_str_len(lh.get()) + c_str_len(rh.get()) + 1);
+	// write the string representation of val to dst, returns the number of written characters
+	size_t write_str(char* dst, size_t size, const value& val)
+	{
+		if (val.type() == value_type::string) {
+			size_t len = 0;
+			for (const char* src = val.get<value_type::string>(); *src; ++src) {
+				dst[len++] = *src;
+			}
+			dst[len] = 0;
+			return len;
+		}
+		toStr(dst, size, val);
+		return c_str_len(dst);
+	}
+} // namespace
 
-	// copy to new string
-	char* dst = str;
-	for (const char* src = lh.get(); *src; ++src) {
-		*dst++ = *src;
+const char* concat_strings(string_table& strings, const value* vals, size_t count)
+{
+	// create new string with an upper bound of the needed size and build it in place
+	size_t size = 1;
+	for (size_t i = 0; i < count; ++i) {
+		size += value_length(vals[i]);
 	}
-	for (const char* src = rh.get(); *src; ++src) {
-		*dst++ = *src;
+	char* str = strings.create(size);
+
+	size_t length = 0;
+	for (size_t i = 0; i < count; ++i) {
+		length += write_str(str + length, size - length, vals[i]);
 	}
-	*dst = 0;
 
-	stack.push(value{}.set<value_type::string>(str));
+	// give back what the numbers did not need
+	strings.shrink(str, length + 1);
+	return str;
+}
+
+void operation<Command::ADD, value_type::string, void>::operator()(
+    basic_eval_stack& stack, value* vals
+)
+{
+	stack.push(value{}.set<value_type::string>(concat_strings(_string_table, vals, 2)));
 }
 
 void operation<Command::IS_EQUAL, value_type::string, void>::operator()(
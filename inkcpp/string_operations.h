@@ -40,6 +40,16 @@ namespace casting
 	};
 } // namespace casting
 
+// true if values of this type are converted to a string when added to one
+constexpr bool concatenates(value_type type)
+{
+	return type == value_type::string || type == value_type::int32 || type == value_type::uint32
+	    || type == value_type::float32 || type == value_type::boolean;
+}
+
+// creates one new string out of the string representations of count values
+const char* concat_strings(string_table& strings, const value* vals, size_t count);
+
 // operation declaration add
 template<>
 class operation<Command::ADD, value_type::string, void> : public operation_base<string_table>
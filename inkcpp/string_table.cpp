@@ -11,10 +11,13 @@ namespace ink::runtime::internal
 {
 string_table::~string_table()
 {
-	// Delete all allocated strings
-	for (auto iter = _table.begin(); iter != _table.end(); ++iter)
-		delete[] iter.key();
-	_table.clear();
+	// Delete all segments
+	for (segment* seg : _segments) {
+		delete[] seg->data;
+		delete seg;
+	}
+	_segments.clear();
+	_current = nullptr;
 }
 
 char* string_table::duplicate(const char* str)
@@ -34,86 +37,207 @@ char* string_table::duplicate(const char* str)
 
 char* string_table::create(size_t length)
 {
-	// allocate the string
-	/// @todo use continuous memory
-	char* data = new char[length];
-	if (data == nullptr)
-		return nullptr;
+	inkAssert(dynamic || _size < capacity, "String table is full, unable to add new data.");
+
+	// find a segment with enough room
+	segment* seg = nullptr;
+	if (length > segment_size / 4) {
+		// large strings get their own segment
+		seg = add_segment(length);
+	} else {
+		if (_current == nullptr || _current->capacity - _current->top < length) {
+			_current = nullptr;
+			// reuse an empty segment before allocating a new one
+			for (segment* s : _segments) {
+				if (s->offsets.size() == 0 && s->capacity == segment_size) {
+					_current = s;
+					break;
+				}
+			}
+			if (_current == nullptr) {
+				_current = add_segment(segment_size);
+			}
+		}
+		seg = _current;
+	}
 
-	// Add to the tree
-	bool success = _table.insert(data, true); // TODO: Should it start as used?
-	inkAssert(success, "String table is full, unable to add new data.");
-	if (! success) {
-		delete[] data;
-		return nullptr;
+	// bump allocate
+	size_t index             = seg->offsets.size();
+	seg->offsets.push()      = static_cast<uint32_t>(seg->top);
+	if (seg->used.size() * 32 <= index) {
+		seg->used.push() = 0;
 	}
+	seg->set_used(index); // TODO: Should it start as used?
+	char* data = seg->data + seg->top;
+	seg->top += length;
 
-	// Return allocated string
+	++_size;
+	++_allocations;
 	return data;
 }
 
+void string_table::shrink(char* str, size_t length)
+{
+	segment* seg = find_segment(str);
+	inkAssert(
+	    seg != nullptr && seg->offsets.size() > 0
+	        && seg->data + seg->offsets.back() == str && length <= seg->top - seg->offsets.back(),
+	    "Only the last created string can be shrunk."
+	);
+	seg->top = seg->offsets.back() + length;
+}
+
+string_table::segment* string_table::add_segment(size_t capacity)
+{
+	segment* seg  = new segment();
+	seg->data     = new char[capacity];
+	seg->capacity = capacity;
+
+	// keep segments sorted by address
+	size_t pos = _segments.size();
+	while (pos > 0 && _segments[pos - 1]->data > seg->data) {
+		--pos;
+	}
+	_segments.insert(pos) = seg;
+	return seg;
+}
+
+void string_table::remove_segment(size_t index)
+{
+	segment* seg = _segments[index];
+	if (seg == _current) {
+		_current = nullptr;
+	}
+	delete[] seg->data;
+	delete seg;
+	for (size_t i = index + 1; i < _segments.size(); ++i) {
+		_segments[i - 1] = _segments[i];
+	}
+	_segments.resize(_segments.size() - 1);
+}
+
+string_table::segment* string_table::find_segment(const char* string) const
+{
+	size_t index = segment_index(string);
+	return index == ~0U ? nullptr : _segments[index];
+}
+
+size_t string_table::segment_index(const char* string) const
+{
+	// last segment starting at or before string
+	size_t begin = 0;
+	size_t end   = _segments.size();
+	while (begin < end) {
+		size_t mid = begin + (end - begin) / 2;
+		if (_segments[mid]->data <= string) {
+			begin = mid + 1;
+		} else {
+			end = mid;
+		}
+	}
+	if (begin == 0 || string >= _segments[begin - 1]->data + _segments[begin - 1]->capacity) {
+		return ~0U;
+	}
+	return begin - 1;
+}
+
+size_t string_table::find_entry(const segment& seg, const char* string)
+{
+	const uint32_t offset = static_cast<uint32_t>(string - seg.data);
+
+	size_t begin = 0;
+	size_t end   = seg.offsets.size();
+	while (begin < end) {
+		size_t mid = begin + (end - begin) / 2;
+		if (seg.offsets[mid] < offset) {
+			begin = mid + 1;
+		} else {
+			end = mid;
+		}
+	}
+	if (begin < seg.offsets.size() && seg.offsets[begin] == offset) {
+		return begin;
+	}
+	return ~0U;
+}
+
 void string_table::clear_usage()
 {
 	// Clear usages
-	for (auto iter = _table.begin(); iter != _table.end(); ++iter)
-		iter.val() = false;
+	for (segment* seg : _segments) {
+		for (uint32_t& bits : seg->used) {
+			bits = 0;
+		}
+	}
 }
 
 void string_table::mark_used(const char* string)
 {
-	auto iter = _table.find(string);
-	if (iter == _table.end())
+	segment* seg = find_segment(string);
+	if (seg == nullptr)
 		return; // assert??
+	size_t index = find_entry(*seg, string);
+	if (index == ~0U)
+		return;
 
 	// set used flag
-	*iter = true;
+	seg->set_used(index);
 }
 
-void string_table::gc()
+size_t string_table::gc()
 {
-	// begin at the start
-	auto iter = _table.begin();
+	size_t freed  = 0;
+	size_t spares = 0;
 
-	const char* last = nullptr;
-	while (iter != _table.end()) {
-		// If the string is not used
-		if (! *iter) {
-			// Delete it
-			delete[] iter.key();
-			_table.erase(iter);
+	for (size_t s = _segments.size(); s-- > 0;) {
+		segment& seg = *_segments[s];
 
-			// Re-establish iterator at last position
-			// TODO: BAD. We need inline delete that doesn't invalidate pointers
-			if (last == nullptr)
-				iter = _table.begin();
-			else {
-				iter = _table.find(last);
-				iter++;
+		// compact the entries of used strings, their memory stays in place
+		size_t kept = 0;
+		for (size_t i = 0; i < seg.offsets.size(); ++i) {
+			if (seg.is_used(i)) {
+				seg.offsets[kept++] = seg.offsets[i];
 			}
+		}
+		freed += seg.offsets.size() - kept;
+		seg.offsets.resize(kept);
+		seg.used.resize((kept + 31) / 32);
+		for (uint32_t& bits : seg.used) {
+			bits = ~0U;
+		}
 
+		if (kept > 0) {
+			// memory behind the last used string can be reused
+			const char* last = seg.data + seg.offsets.back();
+			seg.top          = seg.offsets.back() + strlen(last) + 1;
 			continue;
 		}
 
-		// Next
-		last = iter.key();
-		iter++;
+		// recycle empty segments, but only keep a few of them
+		seg.top = 0;
+		if (seg.capacity != segment_size || spares >= spare_segments) {
+			remove_segment(s);
+		} else {
+			++spares;
+		}
 	}
+
+	_size -= freed;
+	return freed;
 }
 
 size_t string_table::snap(unsigned char* data, const snapper&) const
 {
 	unsigned char* ptr          = data;
 	bool           should_write = data != nullptr;
-	for (size_t i = 0; i < _table.size(); ++i) {
-		for (auto itr = _table.begin(); itr != _table.end(); ++itr) {
-			if (itr.temp_identifier() == i) {
-				size_t length = static_cast<size_t>(strlen(itr.key())) + 1;
-				if (length == 1) {
-					ptr = snap_write(ptr, EMPTY_STRING, 2, should_write);
-				} else {
-					ptr = snap_write(ptr, itr.key(), length, should_write);
-				}
-				break;
+	for (const segment* seg : _segments) {
+		for (uint32_t offset : seg->offsets) {
+			const char* str    = seg->data + offset;
+			size_t      length = static_cast<size_t>(strlen(str)) + 1;
+			if (length == 1) {
+				ptr = snap_write(ptr, EMPTY_STRING, 2, should_write);
+			} else {
+				ptr = snap_write(ptr, str, length, should_write);
 			}
 		}
 	}
@@ -139,19 +263,34 @@ const unsigned char* string_table::snap_load(const unsigned char* data, const lo
 	return ptr + 1;
 }
 
-size_t string_table::get_id(const char* string) const
+string_ids::string_ids(const string_table& table)
+    : _table{table}
 {
-	auto iter = _table.find(string);
-	inkAssert(iter != _table.end(), "Try to fetch not contained string!");
-	return iter.temp_identifier();
+	size_t id = 0;
+	for (const string_table::segment* seg : table._segments) {
+		_first_ids.push() = id;
+		id += seg->offsets.size();
+	}
+}
+
+size_t string_ids::get_id(const char* string) const
+{
+	size_t seg = _table.segment_index(string);
+	inkAssert(seg != ~0U, "Try to fetch not contained string!");
+	size_t index = string_table::find_entry(*_table._segments[seg], string);
+	inkAssert(index != ~0U, "Try to fetch not contained string!");
+	return _first_ids[seg] + index;
 }
 
 config::statistics::string_table string_table::statistics() const
 {
+	int reserved = 0;
+	for (const segment* seg : _segments) {
+		reserved += static_cast<int>(seg->offsets.capacity());
+	}
 	return config::statistics::string_table{
-	    {static_cast<int>(_table.max_size()), static_cast<int>(_table.size())},
+	    {dynamic ? reserved : static_cast<int>(capacity), static_cast<int>(_size)},
 	};
 }
 
-
 } // namespace ink::runtime::internal
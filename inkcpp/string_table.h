@@ -6,23 +6,30 @@
  */
 #pragma once
 
-#include "avl_array.h"
+#include "array.h"
 #include "config.h"
 #include "system.h"
 #include "snapshot_impl.h"
 
 namespace ink::runtime::internal
 {
-// hash tree sorted by string pointers
+// Arena for strings created at runtime.
+// Strings are bump allocated inside segments. A segment is recycled as soon as none of its strings
+// is used anymore, so short lived strings don't fragment the heap.
 class string_table final : public snapshot_interface
 {
 public:
+	string_table() = default;
 	virtual ~string_table();
 
 	// Create a dynamic string of a particular length
 	char* create(size_t length);
 	char* duplicate(const char* str);
 
+	// Shrinks the most recently created string to length, the rest is returned to the arena.
+	// Allows to allocate an upper bound and build the string in place.
+	void shrink(char* str, size_t length);
+
 	// zeroes all usage values
 	void clear_usage();
 
@@ -36,19 +43,72 @@ public:
 
 	bool can_be_migrated() const { return true; }
 
-	// get position of string when iterate through data
-	// used to enable storing a string table references
-	size_t get_id(const char* string) const;
+	// deletes all unused strings, returns the number of deleted strings
+	size_t gc();
 
-	// deletes all unused strings
-	void gc();
+	// Number of strings created so far
+	size_t allocations() const { return _allocations; }
 
 	/** Get usage statistics for the string_table. */
 	config::statistics::string_table statistics() const;
 
 private:
-	avl_array < const char*, bool, ink::size_t,
-	    config::limitStringTable<0, abs(config::limitStringTable)> _table;
-	static constexpr const char*                                   EMPTY_STRING = "\x03";
+	friend class string_ids;
+
+	struct segment {
+		char*  data;
+		size_t capacity;
+		size_t top = 0; // first free byte
+
+		// start of each string in data, ascending
+		managed_array<uint32_t, true, 16, true> offsets;
+		// one usage bit per entry in offsets
+		managed_array<uint32_t, true, 1, true>  used;
+
+		bool is_used(size_t i) const { return (used[i / 32] >> (i % 32)) & 1U; }
+
+		void set_used(size_t i) { used[i / 32] |= 1U << (i % 32); }
+	};
+
+	// segment containing string, nullptr if the string is not part of the table
+	segment* find_segment(const char* string) const;
+	// position of that segment in _segments, or ~0
+	size_t   segment_index(const char* string) const;
+	// index of string in the offsets of its segment, or ~0 if it is no string start
+	static size_t find_entry(const segment& seg, const char* string);
+	segment*      add_segment(size_t capacity);
+	void          remove_segment(size_t index);
+
+	// strings up to this size share segments, larger strings get a segment of their own
+	static constexpr size_t segment_size = 4096;
+	// number of empty segments kept for reuse after a garbage collection
+	static constexpr size_t spare_segments = 2;
+
+	static constexpr bool   dynamic  = config::limitStringTable < 0;
+	static constexpr size_t capacity = abs(config::limitStringTable);
+
+	// all segments, sorted by address of their data
+	managed_array<segment*, true, 4, true> _segments;
+	// segment new strings are appended to
+	segment*                               _current = nullptr;
+
+	size_t                       _size        = 0;
+	size_t                       _allocations = 0;
+	static constexpr const char* EMPTY_STRING = "\x03";
+};
+
+// Ids of strings in a snapshot, which is their position in string_table::snap.
+// Build once per snapshot, only valid while the table is unchanged.
+class string_ids
+{
+public:
+	string_ids(const string_table& table);
+
+	size_t get_id(const char* string) const;
+
+private:
+	const string_table&                  _table;
+	// id of the first string in each segment
+	managed_array<size_t, true, 4, true> _first_ids;
 };
 } // namespace ink::runtime::internal
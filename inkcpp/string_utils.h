@@ -128,7 +128,12 @@ inline constexpr size_t decimal_digits(int32_t number)
 
 inline constexpr size_t decimal_digits(float number)
 {
-	return decimal_digits(static_cast<int32_t>(number)) + 8;
+	// integer part of floats outside of the int32 range has up to 39 digits
+	if (number >= 2147483648.f || number <= -2147483648.f) {
+		return 39 + 9;
+	}
+	// the sign of numbers between -1 and 0 is lost in the integer part
+	return decimal_digits(static_cast<int32_t>(number)) + (number < 0 ? 9 : 8);
 }
 
 inline constexpr size_t value_length(const value& v)
@@ -160,6 +165,8 @@ inline constexpr bool str_equal_len(const char* lh, const char* rh, size_t len)
 		if (! (*rh && *lh && *lh == *rh)) {
 			return false;
 		}
+		++lh;
+		++rh;
 	}
 	return true;
 }
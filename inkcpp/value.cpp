@@ -251,13 +251,15 @@ size_t value::snap(unsigned char* data, const snapper& snapper) const
 	bool           should_write = data != nullptr;
 	ptr                         = snap_write(ptr, _type, should_write);
 	if (_type == value_type::string) {
-		unsigned char buf[max_value_size];
+		// zeroed, so padding does not make equal states differ in their snapshots
+		unsigned char buf[max_value_size] = {};
 		string_type*  res = reinterpret_cast<string_type*>(buf);
 		auto          str = get<value_type::string>();
 		res->allocated    = str.allocated;
 		if (str.allocated) {
+			// the id is only needed when writing
 			res->str = reinterpret_cast<const char*>(
-			    static_cast<std::uintptr_t>(snapper.strings.get_id(str.str))
+			    static_cast<std::uintptr_t>(should_write ? snapper.strings.get_id(str.str) : 0)
 			);
 		} else {
 			res->str = reinterpret_cast<const char*>(
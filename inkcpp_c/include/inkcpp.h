@@ -78,6 +78,11 @@ typedef struct HInkSTory    HInkStory;
 	 */
 	HInkSnapshot*
 	     ink_snapshot_from_binary(const unsigned char* data, size_t length, bool freeOnDestroy);
+	/** @memberof HInkSnapshot
+	 *  @copydoc ink::runtime::snapshot::from_delta()
+	 */
+	HInkSnapshot*
+	     ink_snapshot_from_delta(const HInkSnapshot* base, const unsigned char* data, size_t length);
 	/** @memberof HInkSnapshot
 	 *  @copydoc  ink::runtime::snapshot::num_runners()
 	 *  @param self
@@ -244,6 +249,13 @@ typedef struct HInkSTory    HInkStory;
 	 * @return value to be furthe process by the ink runtime
 	 */
 	typedef void (*InkExternalFunctionVoid)(int argc, const InkValue argv[]);
+	/** @memberof HInkRunner
+	 * Callback receiving consecutive parts of a line, the parts are not null terminated
+	 * @param part start of the part
+	 * @param length number of characters in part
+	 * @param context as passed to ink_runner_get_line_callback()
+	 */
+	typedef void (*InkLineCallback)(const char* part, size_t length, void* context);
 
 	/** @class HInkRunner
 	 * @ingroup clib
@@ -269,6 +281,16 @@ typedef struct HInkSTory    HInkStory;
 	 * @copydoc ink::runtime::runner_interface::getline_alloc()
 	 */
 	const char*       ink_runner_get_line(HInkRunner* self);
+	/** @memberof HInkRunner
+	 * @copydoc ink::runtime::runner_interface::getline(char*,size_t,size_t*)
+	 * @param self
+	 */
+	int  ink_runner_get_line_buffer(HInkRunner* self, char* buffer, size_t capacity, size_t* needed);
+	/** @memberof HInkRunner
+	 * @copydoc ink::runtime::runner_interface::getline(runner_interface::line_callback,void*)
+	 * @param self
+	 */
+	void ink_runner_get_line_callback(HInkRunner* self, InkLineCallback callback, void* context);
 	/** @memberof HInkRunner
 	 * @copydoc ink::runtime::runner_interface::num_tags()
 	 */
@@ -385,6 +407,32 @@ typedef struct HInkSTory    HInkStory;
 	 * @ref ::HInkSnapshot
 	 */
 	HInkSnapshot* ink_globals_create_snapshot(const HInkGlobals* self);
+	/**  @memberof HInkGlobals
+	 * Creates a snapshot in the compact encoding, which is smaller but slower to create and load.
+	 * @ref ::HInkSnapshot
+	 */
+	HInkSnapshot* ink_globals_create_compact_snapshot(const HInkGlobals* self);
+	/**  @memberof HInkGlobals
+	 * Creates a snapshot containing only the changes since base.
+	 * Restore it with ink_snapshot_from_delta() and the same base.
+	 * @ref ::HInkSnapshot
+	 */
+	HInkSnapshot* ink_globals_create_delta_snapshot(const HInkGlobals* self, const HInkSnapshot* base);
+	/** @memberof HInkGlobals
+	 * Callback receiving consecutive parts of a snapshot
+	 * @param data start of the part
+	 * @param length number of bytes in part
+	 * @param context as passed to ink_globals_write_snapshot()
+	 */
+	typedef void (*InkSnapshotSink)(const unsigned char* data, size_t length, void* context);
+	/** @memberof HInkGlobals
+	 * @copydoc ink::runtime::globals_interface::write_snapshot()
+	 * @param self
+	 * @param sink called with each part of the snapshot
+	 * @param context passed to each call of sink
+	 * @sa ink_snapshot_from_binary()
+	 */
+	void ink_globals_write_snapshot(const HInkGlobals* self, InkSnapshotSink sink, void* context);
 	/** @memberof HInkGlobals
 	 * assignes a observer to the variable with the corresponding name.
 	 * The observer is called each time the value of the variable gets assigned.
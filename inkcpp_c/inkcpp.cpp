@@ -144,6 +144,14 @@ extern "C" {
 		);
 	}
 
+	HInkSnapshot*
+	    ink_snapshot_from_delta(const HInkSnapshot* base, const unsigned char* data, size_t length)
+	{
+		return reinterpret_cast<HInkSnapshot*>(snapshot::from_delta(
+		    *reinterpret_cast<const snapshot*>(base), data, static_cast<ink::size_t>(length)
+		));
+	}
+
 	void ink_snapshot_get_binary(
 	    const HInkSnapshot* self, const unsigned char** data, size_t* data_length
 	)
@@ -243,6 +251,33 @@ extern "C" {
 		return reinterpret_cast<runner*>(self)->get()->getline_alloc();
 	}
 
+	int ink_runner_get_line_buffer(HInkRunner* self, char* buffer, size_t capacity, size_t* needed)
+	{
+		ink::size_t size = 0;
+		bool        fits = reinterpret_cast<runner*>(self)->get()->getline(
+		    buffer, static_cast<ink::size_t>(capacity), &size
+		);
+		if (needed) {
+			*needed = size;
+		}
+		return fits;
+	}
+
+	void ink_runner_get_line_callback(HInkRunner* self, InkLineCallback callback, void* context)
+	{
+		struct forward {
+			InkLineCallback callback;
+			void*           context;
+
+			static void call(const char* part, ink::size_t length, void* self)
+			{
+				const forward* f = static_cast<const forward*>(self);
+				f->callback(part, length, f->context);
+			}
+		} f{callback, context};
+		reinterpret_cast<runner*>(self)->get()->getline(&forward::call, &f);
+	}
+
 	int ink_runner_num_tags(const HInkRunner* self)
 	{
 		return reinterpret_cast<const runner*>(self)->get()->num_tags();
@@ -351,6 +386,42 @@ extern "C" {
 		);
 	}
 
+	HInkSnapshot* ink_globals_create_compact_snapshot(const HInkGlobals* self)
+	{
+		return reinterpret_cast<HInkSnapshot*>(
+		    reinterpret_cast<const globals*>(self)->get()->create_snapshot(true)
+		);
+	}
+
+	HInkSnapshot* ink_globals_create_delta_snapshot(const HInkGlobals* self, const HInkSnapshot* base)
+	{
+		return reinterpret_cast<HInkSnapshot*>(
+		    reinterpret_cast<const globals*>(self)->get()->create_delta_snapshot(
+		        *reinterpret_cast<const snapshot*>(base)
+		    )
+		);
+	}
+
+	void ink_globals_write_snapshot(const HInkGlobals* self, InkSnapshotSink sink, void* context)
+	{
+		struct forward : snapshot::sink {
+			InkSnapshotSink callback;
+			void*           context;
+
+			forward(InkSnapshotSink callback, void* context)
+			    : callback{callback}
+			    , context{context}
+			{
+			}
+
+			void write(const void* data, ink::size_t length) override
+			{
+				callback(static_cast<const unsigned char*>(data), length, context);
+			}
+		} f{sink, context};
+		reinterpret_cast<const globals*>(self)->get()->write_snapshot(f);
+	}
+
 	constexpr InkValue ink_value_none()
 	{
 		InkValue value{};
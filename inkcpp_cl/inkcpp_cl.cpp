@@ -32,6 +32,9 @@ std::ostream& operator<<(std::ostream& os, const ink::config::statistics::list_t
 	os << std::string(depth, '\t') << "list_types" << lt.list_types << "\n";
 	os << std::string(depth, '\t') << "flags" << lt.flags << "\n";
 	os << std::string(depth, '\t') << "lists" << lt.lists << "\n";
+	os << std::string(depth, '\t') << "allocations: " << lt.pool.allocations << "\n";
+	os << std::string(depth, '\t') << "reused: " << lt.pool.reused << "\n";
+	os << std::string(depth, '\t') << "free: " << lt.pool.free << "\n";
 	depth -= 1;
 	return os;
 }
@@ -45,6 +48,17 @@ std::ostream& operator<<(std::ostream& os, const ink::config::statistics::string
 	return os;
 }
 
+std::ostream& operator<<(std::ostream& os, const ink::config::statistics::garbage_collection& gc)
+{
+	os << "\n";
+	depth += 1;
+	os << std::string(depth, '\t') << "collections: " << gc.collections << "\n";
+	os << std::string(depth, '\t') << "skipped: " << gc.skipped << "\n";
+	os << std::string(depth, '\t') << "freed: " << gc.freed << "\n";
+	depth -= 1;
+	return os;
+}
+
 std::ostream& operator<<(std::ostream& os, const ink::config::statistics::runner& r)
 {
 	os << "\n";
@@ -69,6 +83,7 @@ std::ostream& operator<<(std::ostream& os, const ink::config::statistics::global
 	os << std::string(depth, '\t') << "variables_observers" << g.variables_observers << "\n";
 	os << std::string(depth, '\t') << "lists" << g.lists;
 	os << std::string(depth, '\t') << "strings" << g.strings;
+	os << std::string(depth, '\t') << "gc" << g.gc;
 	depth -= 1;
 	return os;
 }
@@ -184,6 +184,11 @@ void binary_emitter::write_variable(Command command, CommandFlag flag, const std
 	// Use hash as identifier
 	uint32_t hash = hash_string(name.c_str());
 
+	// Global declarations get a slot, slots are assigned when writing the variable section
+	if (command == Command::SET_VARIABLE && ! (flag & CommandFlag::ASSIGNMENT_IS_REDEFINE)) {
+		_globals.push_back(hash);
+	}
+
 	// Write it out
 	write(command, hash, flag);
 }
@@ -258,6 +263,10 @@ void binary_emitter::output(std::ostream& out)
 	// Sort map on ascending hash code.
 	std::sort(container_hash.begin(), container_hash.end());
 
+	// Global variable slots are the position in the sorted name list
+	std::sort(_globals.begin(), _globals.end());
+	_globals.erase(std::unique(_globals.begin(), _globals.end()), _globals.end());
+
 	// If there's list meta data...
 	if (_list_meta.pos() > 0) {
 		// If there are any lists, terminate the data correctly. Otherwise leave an empty section.
@@ -286,6 +295,7 @@ void binary_emitter::output(std::ostream& out)
 	header._container_hash.setup(
 	    offset, static_cast<ink::uint32_t>(container_hash.size() * sizeof(container_hash_t))
 	);
+	header._variables.setup(offset, static_cast<ink::uint32_t>(_globals.size() * sizeof(hash_t)));
 	header._instructions.setup(offset, _instructions.pos());
 
 	// Write the header
@@ -310,6 +320,9 @@ void binary_emitter::output(std::ostream& out)
 	// Write container hash list
 	emit_section(out, container_hash);
 
+	// Write global variable slots
+	emit_section(out, _globals);
+
 	// Write the container contents (instruction stream)
 	emit_section(out, _instructions);
 
@@ -328,6 +341,8 @@ void binary_emitter::initialize()
 
 	// clear other data
 	_paths.clear();
+	_globals.clear();
+	_fallthrough_targets.clear();
 
 	if (_root != nullptr)
 		delete _root;
@@ -340,6 +355,9 @@ void binary_emitter::finalize()
 {
 	// post process path commands
 	process_paths();
+
+	// fuse common sequences, needs all jump targets to be known
+	fuse_instructions();
 }
 
 void binary_emitter::setContainerIndex(container_t index) { _current->counter_index = index; }
@@ -357,6 +375,7 @@ void binary_emitter::patch_fallthroughs(uint32_t position)
 {
 	// Patch
 	_instructions.set(position, _instructions.pos());
+	_fallthrough_targets.push_back(static_cast<uint32_t>(_instructions.pos()));
 }
 
 void binary_emitter::process_paths()
@@ -446,6 +465,116 @@ void binary_emitter::process_paths()
 	}
 }
 
+namespace
+{
+	constexpr size_t instruction_size = 6; // command(1) + flag(1) + payload(4)
+
+	bool is_comparison(Command cmd)
+	{
+		switch (cmd) {
+			case Command::IS_EQUAL:
+			case Command::NOT_EQUAL:
+			case Command::GREATER_THAN:
+			case Command::LESS_THAN:
+			case Command::GREATER_THAN_EQUALS:
+			case Command::LESS_THAN_EQUALS: return true;
+			default: return false;
+		}
+	}
+
+	// commands which only push one value in evaluation mode
+	bool is_single_push(Command cmd)
+	{
+		switch (cmd) {
+			case Command::STR:
+			case Command::INT:
+			case Command::BOOL:
+			case Command::FLOAT:
+			case Command::LIST:
+			case Command::DIVERT_VAL:
+			case Command::VALUE_POINTER:
+			case Command::PUSH_VARIABLE_VALUE:
+			case Command::VISIT:
+			case Command::TURN:
+			case Command::READ_COUNT: return true;
+			default: return false;
+		}
+	}
+
+	// superinstruction replacing the sequence starting with cmds[0], NUM_COMMANDS if there is none
+	Command fused_command(const Command* cmds, size_t count, size_t& length)
+	{
+		if (count >= 3 && cmds[1] == Command::INT && is_comparison(cmds[2])) {
+			length = 3;
+			switch (cmds[0]) {
+				case Command::PUSH_VARIABLE_VALUE: return Command::VAR_COMPARE;
+				case Command::VISIT: return Command::VISIT_COMPARE;
+				case Command::READ_COUNT: return Command::READ_COUNT_COMPARE;
+				default: break;
+			}
+		}
+		if (count >= 3 && cmds[0] == Command::START_EVAL && is_single_push(cmds[1])
+		    && cmds[2] == Command::END_EVAL) {
+			length = 3;
+			return Command::EVAL_PUSH;
+		}
+		if (count >= 2 && cmds[0] == Command::STR && cmds[1] == Command::NEWLINE) {
+			length = 2;
+			return Command::STR_NEWLINE;
+		}
+		return Command::NUM_COMMANDS;
+	}
+} // namespace
+
+void binary_emitter::collect_jump_targets(
+    const container_data* context, std::vector<bool>& targets
+) const
+{
+	targets[context->offset / instruction_size]     = true;
+	targets[context->end_offset / instruction_size] = true;
+	for (const auto& noop : context->noop_offsets) {
+		targets[noop.second / instruction_size] = true;
+	}
+	for (const container_data* child : context->children) {
+		collect_jump_targets(child, targets);
+	}
+}
+
+void binary_emitter::fuse_instructions()
+{
+	const size_t num_instructions = _instructions.pos() / instruction_size;
+	if (_root == nullptr || num_instructions == 0) {
+		return;
+	}
+
+	// Nothing may jump into the middle of a fused sequence
+	std::vector<bool> targets(num_instructions + 1, false);
+	collect_jump_targets(_root, targets);
+	for (uint32_t offset : _fallthrough_targets) {
+		targets[offset / instruction_size] = true;
+	}
+
+	constexpr size_t max_length = 3;
+	for (size_t i = 0; i < num_instructions;) {
+		Command cmds[max_length];
+		size_t  count = 0;
+		while (count < max_length && i + count < num_instructions
+		       && (count == 0 || ! targets[i + count])) {
+			cmds[count] = static_cast<Command>(_instructions.get((i + count) * instruction_size));
+			++count;
+		}
+
+		size_t  length = 1;
+		Command fused  = fused_command(cmds, count, length);
+		if (fused != Command::NUM_COMMANDS) {
+			_instructions.set(i * instruction_size, fused);
+		} else {
+			length = 1;
+		}
+		i += length;
+	}
+}
+
 void binary_emitter::build_container_data(
     std::vector<container_data_t>& data, container_t parent, const container_data* context
 ) const
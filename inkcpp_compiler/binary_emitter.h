@@ -53,6 +53,9 @@ protected:
 
 private:
 	void process_paths();
+	// replaces common command sequences with superinstructions
+	void fuse_instructions();
+	void collect_jump_targets(const container_data* context, std::vector<bool>& targets) const;
 
 	template<typename type>
 	void emit_section(std::ostream& out, const std::vector<type>& data) const;
@@ -83,11 +86,17 @@ private:
 	binary_stream _lists;
 	binary_stream _instructions;
 
+	// name hashes of declared global variables, their sorted position is the variable slot
+	std::vector<hash_t> _globals;
+
 	// positon to write address
 	// path as string
 	// if path may not exists (used for function fallbackes)
 	// container data
 	// use count index?
 	std::vector<std::tuple<size_t, std::string, bool, container_data*, bool>> _paths;
+
+	// offsets fallthrough diverts jump to
+	std::vector<uint32_t> _fallthrough_targets;
 };
 } // namespace ink::compiler::internal
@@ -96,7 +96,13 @@ const char* CommandStrings[]
        "START_CONTAINER",
        "END_CONTAINER",
 
-       "CALL_EXTERNAL"};
+       "CALL_EXTERNAL",
+
+       "inkcpp_VAR_COMPARE",
+       "inkcpp_VISIT_COMPARE",
+       "inkcpp_READ_COUNT_COMPARE",
+       "inkcpp_STR_NEWLINE",
+       "inkcpp_EVAL_PUSH"};
 
 template<unsigned A, unsigned B>
 struct equal {
@@ -268,8 +268,10 @@ If you want convert it to a string use: `str(value)`.)"
 	    m, "Globals", "Global variable store. Use `globals[var_name]` to read/write them."
 	)
 	    .def(
-	        "create_snapshot", &globals::create_snapshot,
-	        "Creates a snapshot from the current state for later usage"
+	        "create_snapshot", py::overload_cast<bool>(&globals::create_snapshot, py::const_),
+	        "compact"_a = ink::config::compactSnapshots,
+	        "Creates a snapshot from the current state for later usage. Compact snapshots are smaller, "
+	        "but take longer to create and load"
 	    )
 	    .def(
 	        "observe",
@@ -106,5 +106,21 @@ SCENARIO("a restorable array can save/restore/forget", "[array][unit][internals]
 				}
 			}
 		}
+
+		WHEN("we change a value multiple times")
+		{
+			array.set(2, 20);
+			array.set(2, 21);
+			array.set(2, 22);
+
+			THEN("the last value should be returned") { REQUIRE(array[2] == 22); }
+
+			WHEN("we restore the array")
+			{
+				array.restore();
+
+				THEN("we should get the value from before the save") { REQUIRE(array[2] == 2); }
+			}
+		}
 	}
 }
@@ -0,0 +1,133 @@
+#include "catch.hpp"
+
+#include "../inkcpp/compression.h"
+
+#include <story.h>
+#include <runner.h>
+#include <globals.h>
+#include <snapshot.h>
+
+#include <cstring>
+#include <vector>
+
+using namespace ink::runtime;
+
+namespace
+{
+class collect : public snapshot::sink
+{
+public:
+	void write(const void* data, ink::size_t length) override
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		buffer.insert(buffer.end(), bytes, bytes + length);
+	}
+
+	std::vector<unsigned char> buffer;
+};
+} // namespace
+
+SCENARIO("snapshots are stored in the compact encoding", "[snapshot][runtime]")
+{
+	GIVEN("a story after the first line")
+	{
+		std::unique_ptr<story> ink{story::from_file(INK_TEST_RESOURCE_DIR "MoveTo.bin")};
+		globals                store  = ink->new_globals();
+		runner                 thread = ink->new_runner(store);
+		thread->getline();
+
+		WHEN("a plain and a compact snapshot are created")
+		{
+			std::unique_ptr<snapshot> plain{store->create_snapshot(false)};
+			std::unique_ptr<snapshot> compact{store->create_snapshot(true)};
+
+			THEN("the compact one is smaller")
+			{
+				REQUIRE(compact->get_data_len() < plain->get_data_len());
+			}
+			THEN("a truncated compact snapshot is rejected")
+			{
+				std::vector<unsigned char> data(
+				    compact->get_data(), compact->get_data() + compact->get_data_len() - 8
+				);
+				REQUIRE_THROWS(snapshot::from_binary(data.data(), data.size(), false));
+				REQUIRE_THROWS(snapshot::from_binary(data.data(), 4, false));
+			}
+						THEN("both continue the same way")
+			{
+				std::unique_ptr<snapshot> loaded{snapshot::from_binary(
+				    compact->get_data(), compact->get_data_len(), false
+				)};
+				globals loaded_store  = ink->new_globals_from_snapshot(*loaded);
+				runner  loaded_thread = ink->new_runner_from_snapshot(*loaded, loaded_store);
+				REQUIRE(loaded_thread->getall() == thread->getall());
+				REQUIRE(loaded_thread->num_choices() == thread->num_choices());
+				thread->choose(0);
+				loaded_thread->choose(0);
+				REQUIRE(loaded_thread->getall() == thread->getall());
+			}
+		}
+
+		WHEN("a compact snapshot is written into a sink")
+		{
+			collect out;
+			store->write_snapshot(out, true);
+			std::unique_ptr<snapshot> loaded{
+			    snapshot::from_binary(out.buffer.data(), out.buffer.size(), false)
+			};
+			THEN("it can be loaded")
+			{
+				globals loaded_store  = ink->new_globals_from_snapshot(*loaded);
+				runner  loaded_thread = ink->new_runner_from_snapshot(*loaded, loaded_store);
+				REQUIRE(loaded_thread->getall() == thread->getall());
+			}
+		}
+	}
+
+	GIVEN("data with repeating parts")
+	{
+		using namespace ink::runtime::internal;
+		std::vector<unsigned char> data;
+		for (int i = 0; i < 200; ++i) {
+			const char* text = i % 3 ? "visit count " : "turn ";
+			data.insert(data.end(), text, text + std::strlen(text));
+			data.push_back(static_cast<unsigned char>(i));
+		}
+		std::vector<unsigned char> chunk(compressed_bound(data.size()));
+		chunk.resize(compress_chunk(data.data(), data.size(), chunk.data()));
+
+		THEN("the chunk is smaller and expands to the same data")
+		{
+			REQUIRE(chunk.size() < data.size() / 2);
+			std::vector<unsigned char> expanded(data.size());
+			unsigned char*             out = expanded.data();
+			const unsigned char*       end = expand_chunk(
+			    chunk.data(), chunk.data() + chunk.size(), out, expanded.data() + expanded.size()
+			);
+			REQUIRE(end == chunk.data() + chunk.size());
+			REQUIRE(out == expanded.data() + expanded.size());
+			REQUIRE(expanded == data);
+		}
+		THEN("a varint running past the end is detected")
+		{
+			const unsigned char        unfinished[] = {0x80, 0x80};
+			std::vector<unsigned char> expanded(data.size());
+			unsigned char*             out = expanded.data();
+			REQUIRE(
+			    expand_chunk(unfinished, unfinished + 2, out, expanded.data() + expanded.size())
+			    == nullptr
+			);
+		}
+				THEN("a truncated chunk is detected")
+		{
+			std::vector<unsigned char> expanded(data.size());
+			unsigned char*             out = expanded.data();
+			REQUIRE(
+			    expand_chunk(
+			        chunk.data(), chunk.data() + chunk.size() / 2, out, expanded.data() + expanded.size()
+			    )
+			    == nullptr
+			);
+		}
+	}
+}
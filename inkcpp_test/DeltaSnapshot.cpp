@@ -0,0 +1,108 @@
+#include "catch.hpp"
+
+#include <story.h>
+#include <runner.h>
+#include <globals.h>
+#include <snapshot.h>
+
+#include <cstring>
+#include <vector>
+
+using namespace ink::runtime;
+
+SCENARIO("snapshots are stored as the changes to an earlier snapshot", "[snapshot][runtime]")
+{
+	GIVEN("a story which continued since the last snapshot")
+	{
+		std::unique_ptr<story>    ink{story::from_file(INK_TEST_RESOURCE_DIR "MoveTo.bin")};
+		globals                   store  = ink->new_globals();
+		runner                    thread = ink->new_runner(store);
+		thread->getline();
+		std::unique_ptr<snapshot> base{store->create_snapshot()};
+		thread->getall();
+
+		std::unique_ptr<snapshot> delta{store->create_delta_snapshot(*base)};
+		std::unique_ptr<snapshot> full{store->create_snapshot()};
+
+		THEN("the delta is smaller than the full snapshot")
+		{
+			REQUIRE(delta->get_data_len() < full->get_data_len());
+			REQUIRE(delta->num_runners() == full->num_runners());
+		}
+
+		WHEN("the delta is applied to its base")
+		{
+			std::unique_ptr<snapshot> rebuilt{
+			    snapshot::from_delta(*base, delta->get_data(), delta->get_data_len())
+			};
+			THEN("it results in the full snapshot")
+			{
+				REQUIRE(rebuilt != nullptr);
+				REQUIRE(rebuilt->get_data_len() == full->get_data_len());
+				REQUIRE(std::memcmp(rebuilt->get_data(), full->get_data(), full->get_data_len()) == 0);
+			}
+			THEN("the story continues from there")
+			{
+				globals loaded_store  = ink->new_globals_from_snapshot(*rebuilt);
+				runner  loaded_thread = ink->new_runner_from_snapshot(*rebuilt, loaded_store);
+				REQUIRE(loaded_thread->num_choices() == 1);
+				REQUIRE(thread->num_choices() == 1);
+				thread->choose(0);
+				loaded_thread->choose(0);
+				REQUIRE(loaded_thread->getall() == thread->getall());
+			}
+		}
+
+		WHEN("the delta is applied to another snapshot")
+		{
+			std::unique_ptr<snapshot> rebuilt{
+			    snapshot::from_delta(*full, delta->get_data(), delta->get_data_len())
+			};
+			THEN("it is rejected") { REQUIRE(rebuilt == nullptr); }
+		}
+
+		WHEN("the delta is truncated")
+		{
+			std::vector<unsigned char> data(
+			    delta->get_data(), delta->get_data() + delta->get_data_len() - 3
+			);
+			THEN("it is rejected")
+			{
+				REQUIRE(snapshot::from_delta(*base, data.data(), data.size()) == nullptr);
+				REQUIRE(snapshot::from_delta(*base, data.data(), 4) == nullptr);
+			}
+		}
+
+		WHEN("single bytes of the delta are corrupted")
+		{
+			std::vector<unsigned char> data(delta->get_data(), delta->get_data() + delta->get_data_len());
+			int                        rejected = 0;
+			for (size_t i = 0; i < data.size(); ++i) {
+				data[i] ^= 0xFF;
+				try {
+					std::unique_ptr<snapshot> rebuilt{
+					    snapshot::from_delta(*base, data.data(), data.size())
+					};
+					rejected += rebuilt == nullptr;
+				} catch (const ink::ink_exception&) {
+					// the operations were fine, but the rebuilt snapshot is not
+					++rejected;
+				}
+				data[i] ^= 0xFF;
+			}
+			THEN("they are detected without reading outside of the data")
+			{
+				REQUIRE(rejected > 0);
+			}
+		}
+
+		WHEN("the delta is loaded without its base")
+		{
+			THEN("no globals or runner are created")
+			{
+				REQUIRE_FALSE(ink->new_globals_from_snapshot(*delta));
+				REQUIRE_FALSE(ink->new_runner_from_snapshot(*delta));
+			}
+		}
+	}
+}
@@ -0,0 +1,63 @@
+#include "catch.hpp"
+
+#include <story.h>
+#include <runner.h>
+#include <globals.h>
+#include <snapshot.h>
+
+#include <cstring>
+
+using namespace ink::runtime;
+
+SCENARIO("stories and snapshots are loaded from mapped files", "[story][snapshot][runtime]")
+{
+	GIVEN("a story loaded from a mapped file")
+	{
+		std::unique_ptr<story> mapped{story::from_file_mapped(INK_TEST_RESOURCE_DIR "MoveTo.bin")};
+		std::unique_ptr<story> loaded{story::from_file(INK_TEST_RESOURCE_DIR "MoveTo.bin")};
+
+		THEN("it is the same story") { REQUIRE(mapped->hash() == loaded->hash()); }
+
+		WHEN("it is run")
+		{
+			runner thread   = mapped->new_runner();
+			runner expected = loaded->new_runner();
+			THEN("it prints the same as the loaded story")
+			{
+				REQUIRE(thread->getall() == expected->getall());
+				REQUIRE(thread->num_choices() == expected->num_choices());
+				thread->choose(0);
+				expected->choose(0);
+				REQUIRE(thread->getall() == expected->getall());
+			}
+		}
+
+		WHEN("a snapshot is written to a file and mapped again")
+		{
+			globals store  = mapped->new_globals();
+			runner  thread = mapped->new_runner(store);
+			thread->getall();
+			std::unique_ptr<snapshot> snap{store->create_snapshot()};
+			snap->write_to_file(INK_TEST_RESOURCE_DIR "MoveTo.snap");
+			std::unique_ptr<snapshot> mapped_snap{
+			    snapshot::from_file_mapped(INK_TEST_RESOURCE_DIR "MoveTo.snap")
+			};
+
+			THEN("it holds the same data")
+			{
+				REQUIRE(mapped_snap->get_data_len() == snap->get_data_len());
+				REQUIRE(
+				    std::memcmp(mapped_snap->get_data(), snap->get_data(), snap->get_data_len()) == 0
+				);
+			}
+			THEN("the story continues from there")
+			{
+				runner loaded_thread = mapped->new_runner_from_snapshot(*mapped_snap);
+				REQUIRE(loaded_thread->num_choices() == 1);
+				thread->choose(0);
+				loaded_thread->choose(0);
+				REQUIRE(loaded_thread->getall() == thread->getall());
+			}
+		}
+	}
+}
@@ -0,0 +1,87 @@
+#include "catch.hpp"
+
+#include "../inkcpp/functions.h"
+
+using ink::hash_t;
+using ink::runtime::internal::function_base;
+using ink::runtime::internal::functions;
+
+namespace
+{
+struct noop_function : function_base {
+	noop_function()
+	    : function_base(false)
+	{
+	}
+
+	void call(
+	    ink::runtime::internal::basic_eval_stack*, ink::size_t, ink::runtime::internal::string_table&,
+	    ink::runtime::internal::list_table&
+	) override
+	{
+	}
+};
+} // namespace
+
+SCENARIO("bound functions are found by name and call site", "[functions][unit][internals]")
+{
+	GIVEN("a registry for a story calling three functions")
+	{
+		// 17 and 33 land in the same bucket of a small index
+		const hash_t call_sites[] = {1, 17, 1, 33, 5};
+		functions    registry;
+		registry.set_call_sites(call_sites, 5);
+
+		THEN("nothing is bound yet")
+		{
+			REQUIRE(registry.find(1) == nullptr);
+			REQUIRE(registry.at_call_site(0) == nullptr);
+		}
+
+		WHEN("functions are bound")
+		{
+			function_base* one         = new noop_function;
+			function_base* seventeen   = new noop_function;
+			function_base* thirtythree = new noop_function;
+			function_base* again       = new noop_function;
+			registry.add(1, one);
+			registry.add(17, seventeen);
+			registry.add(33, thirtythree);
+			registry.add(1, again);
+
+			THEN("their call sites are resolved")
+			{
+				REQUIRE(registry.at_call_site(0) == one);
+				REQUIRE(registry.at_call_site(1) == seventeen);
+				REQUIRE(registry.at_call_site(2) == one);
+				REQUIRE(registry.at_call_site(3) == thirtythree);
+				REQUIRE(registry.at_call_site(4) == nullptr);
+			}
+
+			THEN("the first binding of a name is used")
+			{
+				REQUIRE(registry.find(1) == one);
+				REQUIRE(registry.find(17) == seventeen);
+				REQUIRE(registry.find(33) == thirtythree);
+				REQUIRE(registry.find(5) == nullptr);
+			}
+		}
+
+		WHEN("many functions are bound")
+		{
+			for (hash_t name = 100; name < 200; ++name) {
+				registry.add(name, new noop_function);
+			}
+			function_base* five = new noop_function;
+			registry.add(5, five);
+
+			THEN("all of them are found")
+			{
+				for (hash_t name = 100; name < 200; ++name) {
+					REQUIRE(registry.find(name) != nullptr);
+				}
+				REQUIRE(registry.at_call_site(4) == five);
+			}
+		}
+	}
+}
@@ -0,0 +1,103 @@
+#include "catch.hpp"
+
+#include "../inkcpp/global_store.h"
+
+using ink::hash_t;
+using ink::runtime::internal::global_store;
+using ink::runtime::internal::value;
+using ink::runtime::internal::value_type;
+
+namespace
+{
+const hash_t A = ink::hash_string("A");
+const hash_t B = ink::hash_string("B");
+const hash_t C = ink::hash_string("C");
+
+value int_v(int32_t i) { return value{}.set<value_type::int32>(i); }
+
+int32_t int_of(const value* v) { return v->get<value_type::int32>(); }
+} // namespace
+
+SCENARIO("global variable store", "[globals][unit][internals]")
+{
+	GIVEN("a store with two slots")
+	{
+		const hash_t slots[] = {A, B};
+		global_store store;
+		store.init(slots, 2);
+
+		THEN("slots are found by name but are not defined yet")
+		{
+			REQUIRE(store.find(A) == 0);
+			REQUIRE(store.find(B) == 1);
+			REQUIRE(store.find(C) == global_store::npos);
+			REQUIRE(store.get(A) == nullptr);
+			REQUIRE(store.get_at(1) == nullptr);
+		}
+
+		WHEN("variables are set")
+		{
+			store.set_at(0, int_v(1));
+			store.set(B, int_v(2));
+			store.set(C, int_v(3));
+
+			THEN("they can be read by name and slot")
+			{
+				REQUIRE(int_of(store.get(A)) == 1);
+				REQUIRE(int_of(store.get_at(1)) == 2);
+				REQUIRE(store.find(C) == 2);
+				REQUIRE(int_of(store.get(C)) == 3);
+			}
+
+			WHEN("the store is saved and changed")
+			{
+				store.save();
+				store.set(A, int_v(10));
+				store.set(A, int_v(11));
+				store.set_at(1, int_v(20));
+
+				THEN("changes are visible") { REQUIRE(int_of(store.get(A)) == 11); }
+
+				THEN("restore brings back the saved values")
+				{
+					store.restore();
+					REQUIRE(int_of(store.get(A)) == 1);
+					REQUIRE(int_of(store.get(B)) == 2);
+					REQUIRE(int_of(store.get(C)) == 3);
+				}
+
+				THEN("forget keeps the changes")
+				{
+					store.forget();
+					REQUIRE(int_of(store.get(A)) == 11);
+					REQUIRE(int_of(store.get(B)) == 20);
+					REQUIRE(! store.is_saved());
+				}
+			}
+		}
+
+		WHEN("a variable is defined after save")
+		{
+			store.save();
+			store.set(A, int_v(5));
+			store.restore();
+
+			THEN("it is undefined again") { REQUIRE(store.get(A) == nullptr); }
+		}
+	}
+
+	GIVEN("a store with many variables")
+	{
+		global_store store;
+		for (int32_t i = 0; i < 200; ++i) {
+			store.set(static_cast<hash_t>(i * 7919), int_v(i));
+		}
+
+		THEN("all of them can be found")
+		{
+			for (int32_t i = 0; i < 200; ++i) {
+				REQUIRE(int_of(store.get(static_cast<hash_t>(i * 7919))) == i);
+			}
+		}
+	}
+}
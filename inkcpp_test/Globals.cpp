@@ -83,5 +83,20 @@ SCENARIO("run story with global variable", "[globals][runtime]")
 
 			THEN("set returns false") { REQUIRE(globStore->set<int32_t>("foo", 3) == false); }
 		}
+
+		WHEN("garbage is collected explicitly after the story ran")
+		{
+			thread->getall();
+			auto before = globStore->statistics().gc;
+			globStore->collect();
+			auto after = globStore->statistics().gc;
+
+			THEN("a collection is recorded and used strings are kept")
+			{
+				REQUIRE(after.collections == before.collections + 1);
+				REQUIRE(after.freed >= before.freed);
+				REQUIRE(*globStore->get<const char*>("concat") == std::string{"Foo:23"});
+			}
+		}
 	}
 }
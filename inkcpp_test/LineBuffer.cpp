@@ -0,0 +1,121 @@
+#include "catch.hpp"
+
+#include <story.h>
+#include <runner.h>
+#include <globals.h>
+
+#include <cstring>
+#include <string>
+
+using namespace ink::runtime;
+
+namespace
+{
+void append_part(const char* part, ink::size_t length, void* context)
+{
+	static_cast<std::string*>(context)->append(part, length);
+}
+} // namespace
+
+SCENARIO("getting lines without allocation", "[output][runtime]")
+{
+	GIVEN("a story with lists and collapsed whitespace")
+	{
+		std::unique_ptr<story> ink{story::from_file(INK_TEST_RESOURCE_DIR "ListLogicStory.bin")};
+		runner                 expected = ink->new_runner();
+		runner                 thread   = ink->new_runner();
+
+		WHEN("lines are written into a buffer")
+		{
+			THEN("they match the lines returned as string")
+			{
+				char buffer[256];
+				while (expected->can_continue()) {
+					std::string line   = expected->getline();
+					ink::size_t needed = 0;
+					REQUIRE(thread->can_continue());
+					REQUIRE(thread->getline(buffer, sizeof(buffer), &needed));
+					REQUIRE(needed == line.size() + 1);
+					REQUIRE(line == buffer);
+				}
+				REQUIRE_FALSE(thread->can_continue());
+			}
+		}
+
+		WHEN("lines are passed to a callback")
+		{
+			THEN("they match the lines returned as string")
+			{
+				while (expected->can_continue()) {
+					std::string line = expected->getline();
+					std::string parts;
+					thread->getline(append_part, &parts);
+					REQUIRE(line == parts);
+				}
+			}
+		}
+
+		WHEN("the buffer is too small")
+		{
+			char   buffer[4];
+			ink::size_t needed = 0;
+			bool   fits   = thread->getline(buffer, sizeof(buffer), &needed);
+			THEN("the line is truncated and kept for the next call")
+			{
+				REQUIRE_FALSE(fits);
+				REQUIRE(needed == 6);
+				REQUIRE(std::strcmp(buffer, "A, ") == 0);
+				char larger[6];
+				REQUIRE(thread->getline(larger, sizeof(larger), &needed));
+				REQUIRE(std::strcmp(larger, "A, C\n") == 0);
+				REQUIRE(thread->getline() == "yes\n");
+			}
+		}
+	}
+}
+
+namespace
+{
+void keep_first_part(const char* part, ink::size_t, void* context)
+{
+	const char** first = static_cast<const char**>(context);
+	if (*first == nullptr) {
+		*first = part;
+	}
+}
+} // namespace
+
+SCENARIO("getting lines of plain story text", "[output][runtime]")
+{
+	GIVEN("two runners of a story with plain text lines")
+	{
+		std::unique_ptr<story> ink{story::from_file(INK_TEST_RESOURCE_DIR "MoveTo.bin")};
+		runner                 first  = ink->new_runner();
+		runner                 second = ink->new_runner();
+
+		WHEN("the lines are passed to a callback")
+		{
+			const char* first_text  = nullptr;
+			const char* second_text = nullptr;
+			first->getline(keep_first_part, &first_text);
+			second->getline(keep_first_part, &second_text);
+
+			THEN("both get the text of the story without a copy")
+			{
+				REQUIRE(first_text == second_text);
+				REQUIRE(
+				    std::strncmp(first_text, "Lava kadaver a very boring introduction", 39) == 0
+				);
+			}
+		}
+
+		WHEN("the lines are returned as string")
+		{
+			THEN("they still end with a newline")
+			{
+				REQUIRE(first->getline() == "Lava kadaver a very boring introduction\n");
+				REQUIRE(first->getline() == "You are head to head to the minister\n");
+			}
+		}
+	}
+}
@@ -0,0 +1,172 @@
+#include "catch.hpp"
+
+#include "../inkcpp/list_table.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+using ink::list_flag;
+using ink::null_flag;
+using ink::runtime::internal::list_table;
+
+namespace
+{
+void add_flag(std::vector<char>& data, list_flag flag, const char* list_name, const char* name)
+{
+	const char* bytes = reinterpret_cast<const char*>(&flag);
+	data.insert(data.end(), bytes, bytes + sizeof(flag));
+	if (list_name) {
+		data.insert(data.end(), list_name, list_name + std::strlen(list_name) + 1);
+	}
+	data.insert(data.end(), name, name + std::strlen(name) + 1);
+}
+
+// list metadata like it is stored in the story binary
+std::vector<char> list_metadata(int small_flags, int big_flags)
+{
+	std::vector<char> data;
+	for (int i = 0; i < small_flags; ++i) {
+		std::string name = "s" + std::to_string(i);
+		add_flag(
+		    data, list_flag{0, static_cast<int16_t>(i + 1)}, i == 0 ? "small" : nullptr, name.c_str()
+		);
+	}
+	for (int i = 0; i < big_flags; ++i) {
+		std::string name = "b" + std::to_string(i);
+		add_flag(
+		    data, list_flag{1, static_cast<int16_t>(i + 1)}, i == 0 ? "big" : nullptr, name.c_str()
+		);
+	}
+	add_flag(data, null_flag, nullptr, "");
+	return data;
+}
+} // namespace
+
+SCENARIO("list operations on lists spanning multiple words", "[lists][unit][internals]")
+{
+	GIVEN("a list table with a list of 40 flags")
+	{
+		std::vector<char> data = list_metadata(3, 40);
+		list_table        table(data.data());
+		list_table::list  l = table.create();
+		table.add_inplace(l, list_flag{0, 1});
+		table.add_inplace(l, list_flag{1, 0});
+		table.add_inplace(l, list_flag{1, 35});
+
+		THEN("count, min and max see flags in all words")
+		{
+			REQUIRE(table.count(l) == 3);
+			REQUIRE(table.min(l) == list_flag{1, 1});
+			REQUIRE(table.max(l) == list_flag{1, 36});
+		}
+
+		THEN("flags and lists are found by name and value")
+		{
+			REQUIRE(table.toFlag("b35").has_value());
+			REQUIRE(*table.toFlag("b35") == list_flag{1, 35});
+			REQUIRE(*table.toFlag("big.b7") == list_flag{1, 7});
+			REQUIRE(*table.toFlag("s2") == list_flag{0, 2});
+			REQUIRE_FALSE(table.toFlag("small.b7").has_value());
+			REQUIRE_FALSE(table.toFlag("b40").has_value());
+			REQUIRE(table.get_list_id("big.b7") == list_flag{1, -1});
+			REQUIRE(table.get_list_id("small") == list_flag{0, -1});
+			REQUIRE(table.external_fvalue_to_internal(list_flag{1, 36}) == list_flag{1, 35});
+			REQUIRE(table.external_fvalue_to_internal(list_flag{1, 41}) == list_flag{1, -1});
+			REQUIRE(table.add(list_flag{1, 35}, 2) == list_flag{1, 37});
+		}
+
+		THEN("single flags are found")
+		{
+			REQUIRE(table.has(l, list_flag{1, 35}));
+			REQUIRE_FALSE(table.has(l, list_flag{1, 34}));
+			REQUIRE(table.has(l, list_flag{0, 1}));
+		}
+
+		WHEN("the list is inverted")
+		{
+			list_table::list inv = table.invert(l);
+			THEN("all other flags of the contained lists are set")
+			{
+				REQUIRE(table.count(inv) == 2 + 38);
+				REQUIRE_FALSE(table.has(inv, list_flag{1, 35}));
+				REQUIRE(table.has(inv, list_flag{1, 39}));
+				REQUIRE(table.min(inv) == list_flag{0, 1});
+				REQUIRE(table.max(inv) == list_flag{1, 40});
+			}
+		}
+
+		WHEN("all flags of the contained lists are taken")
+		{
+			list_table::list all = table.all(l);
+			THEN("it contains the list, but not the other way around")
+			{
+				REQUIRE(table.count(all) == 43);
+				REQUIRE(table.has(all, l));
+				REQUIRE_FALSE(table.has(l, all));
+				REQUIRE_FALSE(table.equal(l, all));
+			}
+		}
+
+		WHEN("the list is compared")
+		{
+			list_table::list copy  = table.add(l, table.create());
+			list_table::list other = table.add(l, list_flag{1, 20});
+			THEN("only equal flags are equal")
+			{
+				REQUIRE(table.equal(l, copy));
+				REQUIRE_FALSE(table.equal(l, other));
+				REQUIRE(table.count(table.sub(other, l)) == 1);
+				REQUIRE(table.equal(table.sub(other, l), list_flag{1, 20}));
+			}
+		}
+
+		WHEN("an operation does not change the list")
+		{
+			int              allocations = table.statistics().pool.allocations;
+			list_table::list same        = table.add(l, list_flag{1, 35});
+			list_table::list none        = table.sub(l, list_flag{1, 20});
+			THEN("the operand is reused")
+			{
+				REQUIRE(same.lid == l.lid);
+				REQUIRE(none.lid == l.lid);
+				REQUIRE(table.statistics().pool.allocations == allocations);
+				REQUIRE(table.statistics().pool.reused == 2);
+			}
+		}
+
+		WHEN("unused lists are collected")
+		{
+			list_table::list tmp = table.add(l, list_flag{1, 20});
+			table.clear_usage();
+			table.mark_used(l);
+			REQUIRE(table.gc() == 1);
+			THEN("their entries are cleared and reused")
+			{
+				REQUIRE(table.statistics().pool.free == 1);
+				list_table::list next = table.create();
+				REQUIRE(next.lid == tmp.lid);
+				REQUIRE(table.count(next) == 0);
+				REQUIRE(table.statistics().pool.free == 0);
+			}
+		}
+	}
+
+	GIVEN("a list with non ASCII names")
+	{
+		std::vector<char> data;
+		add_flag(data, list_flag{0, 1}, "St\xC3\xA4" "dte", "Z\xC3\xBCrich");
+		add_flag(data, list_flag{0, 2}, nullptr, "Bern");
+		add_flag(data, null_flag, nullptr, "");
+		list_table table(data.data());
+
+		THEN("flags and lists are found by their UTF-8 names")
+		{
+			REQUIRE(table.toFlag("Z\xC3\xBCrich").has_value());
+			REQUIRE(*table.toFlag("Z\xC3\xBCrich") == list_flag{0, 0});
+			REQUIRE(*table.toFlag("St\xC3\xA4" "dte.Z\xC3\xBCrich") == list_flag{0, 0});
+			REQUIRE(*table.toFlag("Bern") == list_flag{0, 1});
+			REQUIRE(table.get_list_id("St\xC3\xA4" "dte") == list_flag{0, -1});
+		}
+	}
+}
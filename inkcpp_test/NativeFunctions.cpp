@@ -0,0 +1,71 @@
+#include "catch.hpp"
+
+#include "../inkcpp/include/functional.h"
+#include "../inkcpp/stack.h"
+#include "../inkcpp/string_table.h"
+#include "../inkcpp/list_table.h"
+
+using ink::runtime::internal::function;
+using ink::runtime::internal::list_table;
+using ink::runtime::internal::string_table;
+using ink::runtime::internal::value;
+using ink::runtime::internal::value_type;
+using eval_stack = ink::runtime::internal::eval_stack<16, false>;
+
+SCENARIO("external functions with simple argument types", "[external-functions][unit][internals]")
+{
+	GIVEN("a stack with the arguments of a call")
+	{
+		string_table strings;
+		list_table   lists{};
+		eval_stack   stack;
+		const char   text[] = "static text";
+		stack.push(value{}.set<value_type::int32>(3));
+		stack.push(value{}.set<value_type::float32>(0.5f));
+		stack.push(value{}.set<value_type::string>(text, false));
+
+		WHEN("a function returning one of its arguments is called")
+		{
+			int   a    = 0;
+			float b    = 0;
+			auto  pass = [&a, &b](int x, float y, const char* z) {
+				a = x;
+				b = y;
+				return z;
+			};
+			function fn(pass, false);
+			fn.call(&stack, 3, strings, lists);
+
+			THEN("the arguments are passed in order")
+			{
+				REQUIRE(a == 3);
+				REQUIRE(b == 0.5f);
+			}
+
+			THEN("the returned string is not copied")
+			{
+				value res = stack.pop();
+				REQUIRE(res.type() == value_type::string);
+				REQUIRE(res.get<value_type::string>().str == text);
+				REQUIRE_FALSE(res.get<value_type::string>().allocated);
+				REQUIRE(strings.allocations() == 0);
+				REQUIRE(stack.is_empty());
+			}
+		}
+
+		WHEN("a function returning a new string is called")
+		{
+			auto     create = [](int, float, const char*) { return "other"; };
+			function fn(create, false);
+			fn.call(&stack, 3, strings, lists);
+
+			THEN("the string is copied into the string table")
+			{
+				value res = stack.pop();
+				REQUIRE(std::string(res.get<value_type::string>().str) == "other");
+				REQUIRE(res.get<value_type::string>().allocated);
+				REQUIRE(strings.allocations() == 1);
+			}
+		}
+	}
+}
@@ -0,0 +1,78 @@
+#include "catch.hpp"
+
+#include <story.h>
+#include <runner.h>
+#include <globals.h>
+#include <snapshot.h>
+
+#include <cstring>
+#include <vector>
+
+using namespace ink::runtime;
+
+namespace
+{
+class collect : public snapshot::sink
+{
+public:
+	void write(const void* data, ink::size_t length) override
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		buffer.insert(buffer.end(), bytes, bytes + length);
+		++parts;
+	}
+
+	std::vector<unsigned char> buffer;
+	int                        parts = 0;
+};
+} // namespace
+
+SCENARIO("snapshots are written into a sink", "[snapshot][runtime]")
+{
+	GIVEN("a story with two runners")
+	{
+		std::unique_ptr<story> ink{story::from_file(INK_TEST_RESOURCE_DIR "MoveTo.bin")};
+		globals                store  = ink->new_globals();
+		runner                 thread = ink->new_runner(store);
+		runner                 other  = ink->new_runner(store);
+		thread->getall();
+
+		WHEN("the snapshot is written into a sink")
+		{
+			collect                   out;
+			std::unique_ptr<snapshot> full{store->create_snapshot()};
+			store->write_snapshot(out);
+
+			THEN("it receives the same data section by section")
+			{
+				REQUIRE(out.parts == 4);
+				REQUIRE(out.buffer.size() == full->get_data_len());
+				REQUIRE(std::memcmp(out.buffer.data(), full->get_data(), full->get_data_len()) == 0);
+			}
+			THEN("the data can be loaded")
+			{
+				std::unique_ptr<snapshot> loaded{
+				    snapshot::from_binary(out.buffer.data(), out.buffer.size(), false)
+				};
+				globals loaded_store  = ink->new_globals_from_snapshot(*loaded);
+				runner  loaded_thread = ink->new_runner_from_snapshot(*loaded, loaded_store, 0);
+				REQUIRE(loaded_thread->num_choices() == 1);
+				thread->choose(0);
+				loaded_thread->choose(0);
+				REQUIRE(loaded_thread->getall() == thread->getall());
+			}
+		}
+
+		WHEN("an existing snapshot is written into a sink")
+		{
+			collect                   out;
+			std::unique_ptr<snapshot> full{store->create_snapshot()};
+			full->write(out);
+			THEN("it receives its data")
+			{
+				REQUIRE(out.buffer.size() == full->get_data_len());
+				REQUIRE(std::memcmp(out.buffer.data(), full->get_data(), full->get_data_len()) == 0);
+			}
+		}
+	}
+}
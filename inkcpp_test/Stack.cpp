@@ -123,6 +123,40 @@ SCENARIO("simple_restorable_stack supports save/restore", "[stack][unit][interna
 			}
 		}
 
+		WHEN("the content is replaced")
+		{
+			const int values[] = {7, 8};
+			stack.assign(values, 2);
+
+			THEN("only the new items are on the stack")
+			{
+				int expected[] = {7, 8};
+				stack_matches(stack, expected);
+				REQUIRE(stack.size() == 2);
+			}
+
+			check_restore();
+
+			WHEN("the state is finalized")
+			{
+				stack.forget();
+
+				THEN("the new items stay")
+				{
+					REQUIRE(stack.size() == 2);
+					REQUIRE(stack.top() == 8);
+				}
+			}
+
+			WHEN("the content is cleared and the state is finalized")
+			{
+				stack.assign(nullptr, 0);
+				stack.forget();
+
+				THEN("the stack is empty") { REQUIRE(stack.size() == 0); }
+			}
+		}
+
 		WHEN("items are popped")
 		{
 			stack.pop();
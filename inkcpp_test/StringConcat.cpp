@@ -0,0 +1,27 @@
+#include "catch.hpp"
+
+#include <story.h>
+#include <globals.h>
+#include <runner.h>
+
+using namespace ink::runtime;
+
+SCENARIO("a story adding multiple values to a string", "[strings][runtime]")
+{
+	GIVEN("a story with chains of string additions")
+	{
+		std::unique_ptr<story> ink{story::from_file(INK_TEST_RESOURCE_DIR "StringConcatStory.bin")};
+		globals                globs  = ink->new_globals();
+		runner                 thread = ink->new_runner(globs);
+
+		WHEN("the story is run")
+		{
+			std::string out = thread->getall();
+
+			THEN("all operands are concatenated in order")
+			{
+				REQUIRE(out == "Hello World, 3 times true!\n3World\nWorld30.5World\n");
+			}
+		}
+	}
+}
@@ -0,0 +1,112 @@
+#include "catch.hpp"
+
+#include "../inkcpp/string_table.h"
+
+#include <cstring>
+
+using ink::runtime::internal::string_ids;
+using ink::runtime::internal::string_table;
+
+SCENARIO("string table allocates and collects strings", "[strings][unit][internals]")
+{
+	GIVEN("a string table with a few strings")
+	{
+		string_table table;
+		char*        a = table.duplicate("Hello");
+		char*        b = table.duplicate("World");
+		char*        c = table.duplicate("!");
+
+		THEN("the strings hold their content")
+		{
+			REQUIRE(std::strcmp(a, "Hello") == 0);
+			REQUIRE(std::strcmp(b, "World") == 0);
+			REQUIRE(std::strcmp(c, "!") == 0);
+			REQUIRE(table.statistics().string_refs.size == 3);
+			REQUIRE(table.allocations() == 3);
+		}
+
+		THEN("ids follow the order of creation")
+		{
+			string_ids ids(table);
+			REQUIRE(ids.get_id(a) == 0);
+			REQUIRE(ids.get_id(b) == 1);
+			REQUIRE(ids.get_id(c) == 2);
+		}
+
+		WHEN("only one string is marked as used")
+		{
+			table.clear_usage();
+			table.mark_used(b);
+			size_t freed = table.gc();
+
+			THEN("the other strings are freed")
+			{
+				REQUIRE(freed == 2);
+				REQUIRE(table.statistics().string_refs.size == 1);
+				REQUIRE(std::strcmp(b, "World") == 0);
+				REQUIRE(string_ids(table).get_id(b) == 0);
+			}
+
+			THEN("new strings don't overwrite the used one")
+			{
+				char* d = table.duplicate("Again");
+				REQUIRE(std::strcmp(b, "World") == 0);
+				REQUIRE(std::strcmp(d, "Again") == 0);
+				REQUIRE(string_ids(table).get_id(d) == 1);
+			}
+		}
+
+		WHEN("pointers which are not part of the table are marked")
+		{
+			const char* other = "static";
+			table.clear_usage();
+			table.mark_used(other);
+			table.mark_used(a + 1);
+
+			THEN("nothing is kept") { REQUIRE(table.gc() == 3); }
+		}
+	}
+
+	GIVEN("a string allocated with an upper bound")
+	{
+		string_table table;
+		char*        str = table.create(64);
+		std::strcpy(str, "short");
+		table.shrink(str, 6);
+
+		THEN("the next string starts right behind it")
+		{
+			char* next = table.duplicate("next");
+			REQUIRE(next == str + 6);
+			REQUIRE(std::strcmp(str, "short") == 0);
+		}
+	}
+
+	GIVEN("more strings than fit into one segment")
+	{
+		string_table table;
+		char*        first = table.duplicate("first");
+		char*        last  = nullptr;
+		for (int i = 0; i < 1000; ++i) {
+			last = table.create(32);
+			std::strcpy(last, "filler");
+		}
+
+		WHEN("only the first and last string are used")
+		{
+			table.clear_usage();
+			table.mark_used(first);
+			table.mark_used(last);
+			table.gc();
+
+			THEN("both survive the collection")
+			{
+				REQUIRE(table.statistics().string_refs.size == 2);
+				REQUIRE(std::strcmp(first, "first") == 0);
+				REQUIRE(std::strcmp(last, "filler") == 0);
+				string_ids ids(table);
+				REQUIRE(ids.get_id(first) + ids.get_id(last) == 1);
+			}
+		}
+	}
+}
@@ -0,0 +1,76 @@
+#include "catch.hpp"
+
+#include "header.h"
+#include "command.h"
+
+#include <story.h>
+#include <runner.h>
+#include <globals.h>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+using namespace ink::runtime;
+using ink::Command;
+
+namespace
+{
+std::vector<Command> instructions(const char* filename)
+{
+	std::ifstream     file(filename, std::ios::binary);
+	std::vector<char> data{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+
+	ink::internal::header header;
+	std::memcpy(&header, data.data(), sizeof(header));
+	std::vector<Command> commands;
+	for (uint32_t i = 0; i < header._instructions._bytes; i += 6) {
+		commands.push_back(static_cast<Command>(data[header._instructions._start + i]));
+	}
+	return commands;
+}
+
+bool contains(const std::vector<Command>& commands, Command cmd)
+{
+	for (Command c : commands) {
+		if (c == cmd) {
+			return true;
+		}
+	}
+	return false;
+}
+} // namespace
+
+SCENARIO("common command sequences are fused", "[compiler][runtime]")
+{
+	GIVEN("a story with comparisons, plain text and single pushes")
+	{
+		const char*          filename = INK_TEST_RESOURCE_DIR "Superinstructions.bin";
+		std::vector<Command> commands = instructions(filename);
+
+		THEN("the compiler emits superinstructions")
+		{
+			REQUIRE(contains(commands, Command::VAR_COMPARE));
+			REQUIRE(contains(commands, Command::READ_COUNT_COMPARE));
+			REQUIRE(contains(commands, Command::STR_NEWLINE));
+			REQUIRE(contains(commands, Command::EVAL_PUSH));
+		}
+
+		WHEN("the story is run")
+		{
+			std::unique_ptr<story> ink{story::from_file(filename)};
+			runner                 thread = ink->new_runner();
+
+			THEN("it prints the same as without them")
+			{
+				REQUIRE(thread->getline() == "true\n");
+				REQUIRE(thread->getline() == "false\n");
+				REQUIRE(thread->getline() == "y is 2\n");
+				REQUIRE(thread->getline() == "true\n");
+				REQUIRE(thread->getline() == "Done\n");
+				REQUIRE_FALSE(thread->can_continue());
+			}
+		}
+	}
+}
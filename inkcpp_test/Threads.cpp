@@ -0,0 +1,66 @@
+#include "catch.hpp"
+
+#include <story.h>
+#include <runner.h>
+#include <globals.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ink::runtime;
+
+namespace
+{
+// plays the story to its end, always taking the first choice
+std::string play(story& ink)
+{
+	globals     store  = ink.new_globals();
+	runner      thread = ink.new_runner(store);
+	std::string output;
+	while (true) {
+		while (thread->can_continue()) {
+			output += thread->getline();
+		}
+		if (thread->num_choices() == 0) {
+			break;
+		}
+		thread->choose(0);
+	}
+	return output;
+}
+} // namespace
+
+SCENARIO("one story is shared by runners on several threads", "[runtime][threads]")
+{
+	GIVEN("a story and its output when played on one thread")
+	{
+		std::unique_ptr<story> ink{story::from_file(INK_TEST_RESOURCE_DIR "ListLogicStory.bin")};
+		const std::string      expected = play(*ink);
+
+		WHEN("each thread plays the story with its own globals")
+		{
+			constexpr int            num_threads = 4;
+			constexpr int            num_runs    = 20;
+			std::vector<std::string> results(num_threads * num_runs);
+			std::vector<std::thread> threads;
+			for (int t = 0; t < num_threads; ++t) {
+				threads.emplace_back([&, t]() {
+					for (int run = 0; run < num_runs; ++run) {
+						results[t * num_runs + run] = play(*ink);
+					}
+				});
+			}
+			for (auto& thread : threads) {
+				thread.join();
+			}
+
+			THEN("every run has the same output")
+			{
+				for (const std::string& result : results) {
+					REQUIRE(result == expected);
+				}
+			}
+		}
+	}
+}
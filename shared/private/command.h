@@ -123,6 +123,15 @@ enum class Command : uint8_t {
 	// == Function calls
 	CALL_EXTERNAL,
 
+	// == Superinstructions
+	// The compiler writes them over the first command of a common sequence. The other commands of
+	// the sequence stay in place and are read as operands, so no offsets change.
+	VAR_COMPARE,        ///< PUSH_VARIABLE_VALUE, INT, comparison
+	VISIT_COMPARE,      ///< VISIT, INT, comparison
+	READ_COUNT_COMPARE, ///< READ_COUNT, INT, comparison
+	STR_NEWLINE,        ///< STR, NEWLINE
+	EVAL_PUSH,          ///< START_EVAL, single push, END_EVAL
+
 	NUM_COMMANDS,
 };
 
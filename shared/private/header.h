@@ -58,6 +58,7 @@ struct header {
 	section_t _containers;
 	section_t _container_map;
 	section_t _container_hash;
+	section_t _variables; ///< name hashes of global variables, index is the variable slot
 	section_t _instructions;
 };
 
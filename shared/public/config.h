@@ -30,6 +30,12 @@
 #	define INK_ENABLE_EXCEPTIONS
 #endif
 
+// One story can be shared by runners on different threads, story pointers count their references
+// atomically then
+#if ! defined(INKCPP_NO_THREADS) && (defined(INK_ENABLE_STL) || defined(INK_ENABLE_CSTD))
+#	define INK_ENABLE_THREADS
+#endif
+
 // Only turn on if you have json.hpp and you want to use it with the compiler
 // #define INK_EXPOSE_JSON
 /**
@@ -79,6 +85,17 @@ constexpr int maxFlags                     = -200;
 constexpr int maxLists                     = -50;
 /** max number of arguments for external functions (dynamic not possible). */
 constexpr int maxArrayCallArity            = 10;
+/** number of strings and lists created since the last garbage collection before the next one runs
+ * at the end of a line. 0 collects after every line.
+ * Fixed size string or list tables (positive limits) are collected once they are half full.
+ */
+constexpr int gcThreshold                  = 32;
+/** encoding of snapshots created without choosing one.
+ * Compact snapshots (format version 3) store ids as varints and runs of equal visit counts and
+ * are compressed, which makes them a lot smaller for large stories. Both encodings can always be
+ * loaded. Delta snapshots are computed over the compressed data then and get much larger.
+ */
+constexpr bool compactSnapshots            = false;
 
 /** Staistiac data for different game elements.
  * use this to set you config settings appropriate to your scenario or just to get some insight.
@@ -92,12 +109,20 @@ namespace statistics
 		int size;     /**< current size aka activly used elements inside the container. */
 	};
 
+	/** Statistics of the allocation of list entries. */
+	struct list_pool {
+		int allocations; /**< number of lists created so far. */
+		int reused;      /**< number of results which reused an equal operand instead of a new list. */
+		int free;        /**< number of empty list entries waiting for reuse. */
+	};
+
 	/** Statistics for managed lists, including static and dynamic enties. */
 	struct list_table {
 		container editable_lists; /**< based on @ref ink::config::limitEditableLists */
 		container list_types;     /**< based on @ref ink::config::maxListTypes */
 		container flags;          /**< based on @ref ink::config::maxFlags */
 		container lists;          /**< based on @ref ink::config::maxLists */
+		list_pool pool;           /**< reuse of list entries */
 	};
 
 	/** Statistiacs to managed strings, which are build at runtime. */
@@ -105,12 +130,20 @@ namespace statistics
 		container string_refs; /**< based on @ref limitStringTable */
 	};
 
+	/** Statistics of the garbage collection of strings and lists. */
+	struct garbage_collection {
+		int collections; /**< number of collections run so far. */
+		int skipped;     /**< number of line ends without collection, see @ref ink::config::gcThreshold */
+		int freed;       /**< number of strings and lists freed so far. */
+	};
+
 	/** Stastics for state managed for one runtime. */
 	struct global {
 		container  variables;           /**< based on @ref ink::config::limitGlobalVariables */
 		container  variables_observers; /**< based on @ref ink::config::limitGlobalVariableObservers */
 		list_table lists;               /**< Staistics for all lists associated with this runtime. */
 		string_table strings;           /**< Staistics for all strings associtade with this runtime. */
+		garbage_collection gc;          /**< Statistics of the garbage collection. */
 	};
 
 	/** Stastics for state managed for one thread inside a runtime. */
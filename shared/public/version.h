@@ -9,6 +9,6 @@
 #include "system.h"
 
 namespace ink {
-constexpr uint32_t InkBinVersion = 2;  ///< Supportet version of ink.bin files
+constexpr uint32_t InkBinVersion = 4;  ///< Supportet version of ink.bin files
 constexpr uint32_t InkVersion    = 21; ///< Supported version of ink.json files
 };